@@ -24,9 +24,6 @@ cp /usr/lib/gcc/$HOST/9.3-posix/libgomp-1.dll \
     /usr/$HOST/bin/libfftw3-3.dll \
     /usr/$HOST/bin/libwinpthread-1.dll \
     /usr/$HOST/bin/zlib1.dll \
-    /usr/libtorch/bin/libopenblas.dll \
-    /usr/libtorch/lib/libc10.dll \
-    /usr/libtorch/lib/libtorch_cpu.dll \
     $tmp
 
 cd /dist
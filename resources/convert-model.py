@@ -0,0 +1,159 @@
+#!/usr/bin/env python3
+#
+# Exports the weights of the DeepFormants TorchScript model into the flat
+# binary read by the built-in inference engine (src/analysis/formant/deepformants/network.cpp).
+# Only the standard library is needed, the archive is unpickled without torch.
+#
+# Usage: convert-model.py [model.pt] [model.bin]
+#
+# Layout, all little-endian:
+#   header    char magic[4] = "DFNN", u32 version = 1, u32 layerCount, u32 reserved
+#   layers    layerCount x { u32 inputs, u32 outputs, u32 activation, u32 offset }
+#   data      per layer, float32 weights [outputs][inputs] at the given byte offset,
+#             then float32 bias [outputs] on the next 64 byte boundary
+#
+# activation is 0 for none, 1 for the logistic sigmoid.
+
+import pickle
+import struct
+import sys
+import zipfile
+
+MAGIC = b'DFNN'
+VERSION = 1
+ALIGN = 64
+
+ACT_NONE = 0
+ACT_SIGMOID = 1
+
+
+class Module:
+    kind = None
+
+    def __setstate__(self, state):
+        self.state = state
+
+
+class Tensor:
+    def __init__(self, storage, offset, size, stride):
+        self.storage = storage
+        self.offset = offset
+        self.size = tuple(size)
+        self.stride = tuple(stride)
+
+
+def rebuild_tensor(storage, offset, size, stride, *args):
+    return Tensor(storage, offset, size, stride)
+
+
+class Unpickler(pickle.Unpickler):
+    def find_class(self, module, name):
+        if module == 'torch._utils' and name == '_rebuild_tensor_v2':
+            return rebuild_tensor
+        if module == 'torch' and name.endswith('Storage'):
+            return name
+        if module == 'collections' and name == 'OrderedDict':
+            return dict
+        if module.startswith('__torch__'):
+            return type(name, (Module,), {'kind': name})
+        raise pickle.UnpicklingError('unexpected global %s.%s' % (module, name))
+
+    def persistent_load(self, pid):
+        tag, kind, key, location, numel = pid
+        if kind != 'FloatStorage':
+            raise pickle.UnpicklingError('only float32 weights are supported, got ' + kind)
+        return key
+
+
+def load_archive(path):
+    with zipfile.ZipFile(path) as z:
+        names = z.namelist()
+        prefix = next(n[:-len('data.pkl')] for n in names if n.endswith('/data.pkl'))
+        root = Unpickler(z.open(prefix + 'data.pkl')).load()
+        storages = {n[len(prefix + 'data/'):]: z.read(n) for n in names if n.startswith(prefix + 'data/')}
+    return root, storages
+
+
+def tensor_data(t, storages):
+    # Linear weights and biases are saved contiguous.
+    if t.stride != tuple(_prod(t.size[i + 1:]) for i in range(len(t.size))):
+        raise ValueError('non contiguous tensor')
+    count = _prod(t.size)
+    return storages[t.storage][4 * t.offset: 4 * (t.offset + count)]
+
+
+def _prod(xs):
+    p = 1
+    for x in xs:
+        p *= x
+    return p
+
+
+def flatten(module, layers):
+    if module.kind == 'Linear':
+        w = module.state['weight']
+        b = module.state['bias']
+        layers.append([w, b, ACT_NONE])
+    elif module.kind == 'Sigmoid':
+        if not layers or layers[-1][2] != ACT_NONE:
+            raise ValueError('sigmoid without a preceding linear layer')
+        layers[-1][2] = ACT_SIGMOID
+    elif module.kind == 'Sequential':
+        for key in sorted((k for k in module.state if k != 'training'), key=int):
+            flatten(module.state[key], layers)
+    elif module.kind == 'Lambda':
+        # Only reshapes the input to rows of features.
+        pass
+    else:
+        raise ValueError('unsupported module ' + module.kind)
+
+
+def align(n):
+    return (n + ALIGN - 1) // ALIGN * ALIGN
+
+
+def convert(src, dst):
+    root, storages = load_archive(src)
+
+    layers = []
+    flatten(root, layers)
+
+    header_size = 16 + 16 * len(layers)
+    offset = align(header_size)
+
+    header = bytearray(MAGIC + struct.pack('<III', VERSION, len(layers), 0))
+    blocks = []
+
+    previous = None
+    for w, b, act in layers:
+        outputs, inputs = w.size
+        if b.size != (outputs,) or (previous is not None and previous != inputs):
+            raise ValueError('layer shapes do not chain')
+        previous = outputs
+
+        header += struct.pack('<IIII', inputs, outputs, act, offset)
+
+        weights = tensor_data(w, storages)
+        bias = tensor_data(b, storages)
+        blocks.append((offset, weights))
+        offset = align(offset + len(weights))
+        blocks.append((offset, bias))
+        offset = align(offset + len(bias))
+
+    out = bytearray(offset)
+    out[:len(header)] = header
+    for start, data in blocks:
+        out[start:start + len(data)] = data
+
+    with open(dst, 'wb') as f:
+        f.write(out)
+
+    for w, b, act in layers:
+        print('%4d -> %4d %s' % (w.size[1], w.size[0], 'sigmoid' if act == ACT_SIGMOID else 'linear'))
+    print('wrote %s, %d bytes' % (dst, len(out)))
+
+
+if __name__ == '__main__':
+    src = sys.argv[1] if len(sys.argv) > 1 else 'model.pt'
+    dst = sys.argv[2] if len(sys.argv) > 2 else 'model.bin'
+    convert(src, dst)
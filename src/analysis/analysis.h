@@ -10,5 +10,6 @@
 #include "formant/formant.h"
 #include "invglot/invglot.h"
 #include "util/util.h"
+#include "vad/vad.h"
 
 #endif // ANALYSIS_H
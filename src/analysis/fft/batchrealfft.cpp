@@ -0,0 +1,130 @@
+#include "fft.h"
+#include <algorithm>
+#include <stdexcept>
+
+using namespace Analysis;
+
+BatchRealFFT::BatchRealFFT(size_t n, int count)
+    : mSize(n),
+      mCount(count),
+      mIn(fftw_alloc_real(n * count)),
+      mOut(fftw_alloc_complex((n / 2 + 1) * count))
+{
+    const int size = n;
+    const int idist = n;
+    const int odist = n / 2 + 1;
+
+    std::lock_guard<std::mutex> lock(sFFTWPlanMutex);
+    importFFTWisdom();
+    mPlanForward = fftw_plan_many_dft_r2c(1, &size, count, mIn, nullptr, 1, idist, mOut, nullptr, 1, odist, FFTW_EM_FLAG);
+    mPlanBackward = fftw_plan_many_dft_c2r(1, &size, count, mOut, nullptr, 1, odist, mIn, nullptr, 1, idist, FFTW_EM_FLAG);
+}
+
+BatchRealFFT::~BatchRealFFT()
+{
+    std::lock_guard<std::mutex> lock(sFFTWPlanMutex);
+    fftw_destroy_plan(mPlanForward);
+    fftw_destroy_plan(mPlanBackward);
+    fftw_free(mIn);
+    fftw_free(mOut);
+}
+
+double BatchRealFFT::input(int frame, int index) const
+{
+    checkInputIndex(frame, index);
+    return mIn[frame * mSize + index];
+}
+
+double& BatchRealFFT::input(int frame, int index)
+{
+    checkInputIndex(frame, index);
+    return mIn[frame * mSize + index];
+}
+
+std::dcomplex BatchRealFFT::output(int frame, int index) const
+{
+    checkOutputIndex(frame, index);
+    return std::cast_dcomplex(mOut[frame * getOutputLength() + index]);
+}
+
+std::dcomplex& BatchRealFFT::output(int frame, int index)
+{
+    checkOutputIndex(frame, index);
+    return std::cast_dcomplex(mOut[frame * getOutputLength() + index]);
+}
+
+void BatchRealFFT::computeForward()
+{
+    fftw_execute(mPlanForward);
+}
+
+void BatchRealFFT::computeBackward()
+{
+    fftw_execute(mPlanBackward);
+}
+
+size_t BatchRealFFT::getInputLength() const
+{
+    return mSize;
+}
+
+size_t BatchRealFFT::getOutputLength() const
+{
+    return mSize / 2 + 1;
+}
+
+int BatchRealFFT::getCount() const
+{
+    return mCount;
+}
+
+void BatchRealFFT::checkInputIndex(int frame, int index) const
+{
+    if (frame < 0 || frame >= mCount || index < 0 || index >= getInputLength()) {
+        throw std::runtime_error("FFT::BatchRealFFT] Input array index out of range");
+    }
+}
+
+void BatchRealFFT::checkOutputIndex(int frame, int index) const
+{
+    if (frame < 0 || frame >= mCount || index < 0 || index >= getOutputLength()) {
+        throw std::runtime_error("FFT::BatchRealFFT] Output array index out of range");
+    }
+}
+
+std::unique_ptr<BatchRealFFT> BatchRealFFTPool::acquire(size_t n, int count)
+{
+    std::unique_ptr<BatchRealFFT> fft;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        auto it = std::find_if(mFree.begin(), mFree.end(),
+                [&](const auto& p) { return p->getInputLength() == n && p->getCount() == count; });
+        if (it != mFree.end()) {
+            fft = std::move(*it);
+            mFree.erase(it);
+        }
+    }
+    if (!fft) {
+        fft = std::make_unique<BatchRealFFT>(n, count);
+    }
+    return fft;
+}
+
+void BatchRealFFTPool::release(std::unique_ptr<BatchRealFFT> fft)
+{
+    rpm::vector<std::unique_ptr<BatchRealFFT>> stale;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        // Plans of another size are not coming back into use once the frame length changed.
+        for (auto it = mFree.begin(); it != mFree.end();) {
+            if ((*it)->getInputLength() != fft->getInputLength()) {
+                stale.push_back(std::move(*it));
+                it = mFree.erase(it);
+            }
+            else {
+                ++it;
+            }
+        }
+        mFree.push_back(std::move(fft));
+    }
+}
@@ -4,6 +4,7 @@
 #include "rpcxx.h"
 #include <fftw3.h>
 #include <complex>
+#include <memory>
 #include <mutex>
 
 #if defined(EMSCRIPTEN)
@@ -85,6 +86,58 @@ namespace Analysis
         fftw_complex *mOut;
     };
 
+    /*
+     *  Real transforms of count frames of the same size, executed by a single
+     *  FFTW plan. Frames are stored back to back in the input and output arrays.
+     */
+    class BatchRealFFT
+    {
+    public:
+        BatchRealFFT(size_t n, int count);
+        ~BatchRealFFT();
+
+        double input(int frame, int index) const;
+        double& input(int frame, int index);
+
+        std::dcomplex output(int frame, int index) const;
+        std::dcomplex& output(int frame, int index);
+
+        void computeForward();
+        void computeBackward();
+
+        size_t getInputLength() const;
+        size_t getOutputLength() const;
+        int getCount() const;
+
+    private:
+        void checkInputIndex(int frame, int index) const;
+        void checkOutputIndex(int frame, int index) const;
+
+        size_t mSize;
+        int mCount;
+        fftw_plan mPlanForward;
+        fftw_plan mPlanBackward;
+
+        double *mIn;
+        fftw_complex *mOut;
+    };
+
+    /*
+     *  Keeps batch plans alive between calls so that FFTW planning is paid
+     *  once per (n, count) rather than on every call. Each concurrent user
+     *  takes its own plan and hands it back when done.
+     */
+    class BatchRealFFTPool
+    {
+    public:
+        std::unique_ptr<BatchRealFFT> acquire(size_t n, int count);
+        void release(std::unique_ptr<BatchRealFFT> fft);
+
+    private:
+        std::mutex mMutex;
+        rpm::vector<std::unique_ptr<BatchRealFFT>> mFree;
+    };
+
     class ComplexFFT
     {
     public:
@@ -110,6 +163,10 @@ namespace Analysis
     };
 
     rpm::vector<double> fft_n(Analysis::RealFFT& fft, const rpm::vector<double>& signal);
+    rpm::vector<double> fft_n(Analysis::RealFFT& fft, const double *signal, int n);
+
+    // Smallest 2^a 3^b 5^c >= n, FFTW transforms these about as fast as powers of two.
+    int nextFastLength(int n);
 }
 
 #endif // ANALYSIS_FFT_H
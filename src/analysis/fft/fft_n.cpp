@@ -1,8 +1,13 @@
 #include "fft.h"
+#include <algorithm>
+#include <mutex>
 
+// Shared by every pipeline in the process, entries are never removed.
+static std::mutex windowsMutex;
 static rpm::map<int, rpm::vector<double>> windows;
 
 static const rpm::vector<double>& getWindow(int N) {
+    std::lock_guard<std::mutex> lock(windowsMutex);
     auto wit = windows.find(N);
     if (wit == windows.end()) {
         constexpr double a0 = 0.35875;
@@ -22,16 +27,20 @@ static const rpm::vector<double>& getWindow(int N) {
 }
 
 rpm::vector<double> Analysis::fft_n(Analysis::RealFFT& fft, const rpm::vector<double>& signal)
+{
+    return fft_n(fft, signal.data(), signal.size());
+}
+
+rpm::vector<double> Analysis::fft_n(Analysis::RealFFT& fft, const double *signal, int n)
 {
     const int nfft = fft.getInputLength();
-    const int n = signal.size();
 
     if (n <= nfft) {
         for (int i = 0; i < nfft; ++i) {
             fft.input(i) = 0.0;
         }
 
-        auto w = getWindow(n);
+        const auto& w = getWindow(n);
 
         for (int j = 0; j < n; ++j) {
             double sample = signal[j];
@@ -42,7 +51,7 @@ rpm::vector<double> Analysis::fft_n(Analysis::RealFFT& fft, const rpm::vector<do
     else {
         const int N = nfft - 1;
         
-        auto w = getWindow(nfft);
+        const auto& w = getWindow(nfft);
         
         for (int j = 0; j < nfft; ++j) {
             int i = n / 2 - nfft / 2 + j;
@@ -61,3 +70,21 @@ rpm::vector<double> Analysis::fft_n(Analysis::RealFFT& fft, const rpm::vector<do
     }
     return h;
 }
+
+int Analysis::nextFastLength(int n)
+{
+    int best = 1;
+    while (best < n) {
+        best <<= 1;
+    }
+    for (int p5 = 1; p5 < best; p5 *= 5) {
+        for (int p35 = p5; p35 < best; p35 *= 3) {
+            int m = p35;
+            while (m < n) {
+                m <<= 1;
+            }
+            best = std::min(best, m);
+        }
+    }
+    return best;
+}
@@ -1,4 +1,5 @@
 #include "filter.h"
+#include <algorithm>
 
 rpm::vector<double> Analysis::filter(const rpm::vector<double>& a, const rpm::vector<double>& x)
 {
@@ -44,6 +45,18 @@ rpm::vector<double> Analysis::filter(const rpm::vector<double>& b, const rpm::ve
     return y;
 }
 
+void Analysis::firFilter(const double *b, int nb, const double *x, int begin, int end, double *y)
+{
+    for (int i = begin; i < end; ++i) {
+        const int taps = std::min(nb, i + 1);
+        double sum = 0.0;
+        for (int j = 0; j < taps; ++j) {
+            sum += b[j] * x[i - j];
+        }
+        y[i - begin] = sum;
+    }
+}
+
 static inline double G(double x, int L, double alpha)
 {
     const int N = L - 1;
@@ -11,6 +11,9 @@ namespace Analysis {
     
     rpm::vector<double> filter(const rpm::vector<double>& b, const rpm::vector<double>& a, const rpm::vector<double>& x);
 
+    // FIR output for i in [begin, end) into y[i - begin], x is taken as zero before its start.
+    void firFilter(const double *b, int nb, const double *x, int begin, int end, double *y);
+
     rpm::vector<std::array<double, 6>> butterworthHighpass(int N, double fc, double fs);
     rpm::vector<std::array<double, 6>> butterworthLowpass(int N, double fc, double fs);
 
@@ -18,6 +21,9 @@ namespace Analysis {
 
     rpm::vector<double> sosfilter(const rpm::vector<std::array<double, 6>>& sos, const rpm::vector<double>& x);
 
+    // Runs every section in a single pass from rest, y may be x. state holds two values per section.
+    void sosfilter(const rpm::vector<std::array<double, 6>>& sos, const double *x, int length, double *y, double *state);
+
     rpm::vector<double> sosfiltfilt(const rpm::vector<std::array<double, 6>>& sos, const rpm::vector<double>& x);
 
     rpm::vector<double> gaussianWindow(int length, double alpha);
@@ -15,6 +15,26 @@ rpm::vector<double> Analysis::sosfilter(const rpm::vector<std::array<double, 6>>
     return y;
 }
 
+void Analysis::sosfilter(const rpm::vector<std::array<double, 6>>& sos, const double *x, int length, double *y, double *state)
+{
+    const int ns = sos.size();
+    std::fill(state, state + 2 * ns, 0.0);
+
+    // Transposed direct form II, a[0] is taken to be 1 as in filter().
+    for (int i = 0; i < length; ++i) {
+        double v = x[i];
+        for (int s = 0; s < ns; ++s) {
+            const auto& sec = sos[s];
+            double *z = state + 2 * s;
+            const double out = sec[0] * v + z[0];
+            z[0] = sec[1] * v - sec[4] * out + z[1];
+            z[1] = sec[2] * v - sec[5] * out;
+            v = out;
+        }
+        y[i] = v;
+    }
+}
+
 rpm::vector<double> Analysis::sosfiltfilt(const rpm::vector<std::array<double, 6>>& sos, const rpm::vector<double>& x)
 {
     rpm::vector<double> y = sosfilter(sos, x);
@@ -3,29 +3,62 @@
 #include "../util/util.h"
 #include <algorithm>
 #include <QFile>
+#include <iostream>
 
 using namespace Analysis::Formant;
 using Analysis::FormantResult;
 
 using namespace Eigen;
 
-DeepFormants::DeepFormants()
+DeepFormants::DeepFormants(int intraOpThreads, bool quantized)
+    : extractor(std::make_unique<FeatureExtractor>())
 {
-    try {
-        QFile file(":/model.pt");
-        if (file.open(QIODevice::ReadOnly)) {
-            QByteArray buffer = file.readAll();
-            std::string data(buffer.data(), buffer.size());
-            std::istringstream stream(data);
-            module = torch::jit::load(stream, c10::kCPU);
-            file.close();
+#ifdef WITH_TORCH
+    if (!quantized) {
+        if (intraOpThreads > 0) {
+            at::set_num_threads(intraOpThreads);
         }
+
+        try {
+            QFile file(":/model.pt");
+            if (file.open(QIODevice::ReadOnly)) {
+                QByteArray buffer = file.readAll();
+                std::string data(buffer.data(), buffer.size());
+                std::istringstream stream(data);
+                module = torch::jit::load(stream, c10::kCPU);
+                file.close();
+            }
+        }
+        catch (const c10::Error& e) {
+            std::cerr << "Error loading the model: " << e.msg() << std::endl;
+            return;
+        }
+
+        // Inlines the weights as constants and fuses what it can, the model is never trained here.
+        try {
+            module.eval();
+            auto frozen = torch::jit::freeze(module);
+            module = torch::jit::optimize_for_inference(frozen);
+        }
+        catch (const c10::Error& e) {
+            std::cerr << "Could not freeze the model, running it as is: " << e.msg() << std::endl;
+        }
+        return;
     }
-    catch (const c10::Error& e) {
-        std::cerr << "Error loading the model: " << e.msg() << std::endl;
+#endif
+    (void) intraOpThreads;
+
+    network = std::make_unique<DenseNetwork>(":/model.bin",
+            quantized ? DenseNetwork::Precision::Int8 : DenseNetwork::Precision::Float32);
+    if (network->getInputLength() != FeatureExtractor::numFeatures || network->getOutputLength() < 4) {
+        throw std::runtime_error("Formant::DeepFormants] Network does not match the features");
     }
 }
 
+DeepFormants::~DeepFormants()
+{
+}
+
 void DeepFormants::setFrameAudio(const rpm::vector<double>& x)
 {
     xv = x;
@@ -33,26 +66,58 @@ void DeepFormants::setFrameAudio(const rpm::vector<double>& x)
 
 FormantResult DeepFormants::solve(const double *, int, double)
 {
-    Map<const ArrayXd> x(xv.data(), xv.size());
+    FormantResult result;
+    solveFrames(xv.data(), 1, xv.size(), xv.size(), &result);
+    return result;
+}
 
-    ArrayXd features = build_feature_row(x);
-    
-    torch::Tensor input = torch::ones({1, 350});
-    for (int i = 0; i < 350; ++i) {
-        input[0][i] = features(i);
-    }
+void DeepFormants::solveFrames(const double *frames, int count, int length, int stride, FormantResult *results)
+{
+    constexpr int numFeatures = FeatureExtractor::numFeatures;
 
-    torch::Tensor output = module.forward({input}).toTensor();
+    for (int begin = 0; begin < count; begin += maxBatch) {
+        const int n = std::min(maxBatch, count - begin);
 
-    ArrayXd result = Map<ArrayXf>(output.data_ptr<float>(), output.size(1)).cast<double>();
+        features.resize(n * numFeatures);
 
-    FormantResult formantResult;
-    for (int i = 0; i < 4; ++i) {
-        formantResult.formants.push_back({
-            .frequency = 1000 * result(i),
-            .bandwidth = 80,
-        });
-    }
+        for (int i = 0; i < n; ++i) {
+            extractor->compute(frames + (begin + i) * stride, length, features.data() + i * numFeatures);
+        }
+
+#ifdef WITH_TORCH
+        torch::Tensor output;
+#endif
+        const float *y;
+        int outputs;
+
+        if (network) {
+            outputs = network->getOutputLength();
+            predictions.resize(n * outputs);
+            network->forward(features.data(), n, predictions.data());
+            y = predictions.data();
+        }
+#ifdef WITH_TORCH
+        else {
+            c10::InferenceMode guard;
 
-    return formantResult;
+            // Wraps the feature buffer, which outlives the forward pass.
+            torch::Tensor input = torch::from_blob(features.data(), {n, numFeatures}, torch::kFloat32);
+            output = module.forward({input}).toTensor().contiguous();
+
+            y = output.data_ptr<float>();
+            outputs = output.size(1);
+        }
+#endif
+
+        for (int i = 0; i < n; ++i) {
+            auto& formants = results[begin + i].formants;
+            formants.resize(4);
+            for (int k = 0; k < 4; ++k) {
+                formants[k] = {
+                    .frequency = 1000 * y[i * outputs + k],
+                    .bandwidth = 80,
+                };
+            }
+        }
+    }
 }
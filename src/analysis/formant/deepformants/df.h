@@ -2,10 +2,105 @@
 #define DEEP_FORMANTS_H
 
 #include <Eigen/Dense>
+#include <QFile>
+#include "../../fft/fft.h"
 
 #define MAX_AMPLITUDE_16BIT (32767.0)
 
-template<typename Derived>
-extern Eigen::ArrayXd build_feature_row(const Eigen::ArrayBase<Derived>& x);
+namespace Analysis::Formant {
+
+    /*
+     *  Input features of the DeepFormants model: 50 cepstral coefficients of
+     *  the averaged periodogram, then 30 of the LPC spectrum for each order
+     *  from 8 to 17.
+     *
+     *  Transforms and work buffers belong to the instance, so solvers running
+     *  on different threads each keep their own extractor.
+     */
+    class FeatureExtractor {
+    public:
+        static constexpr int numFeatures = 350;
+
+        FeatureExtractor();
+
+        // x is the frame as given to DeepFormants.
+        void compute(const double *x, int length, float *out);
+
+    private:
+        void periodogram(const double *x, int length);
+        void arSpectra(const double *r);
+        void cepstrum(int numCoefs, float *out);
+
+        RealFFT fftPs;
+        BatchRealFFT fftAr;
+        ReReFFT dct;
+
+        rpm::vector<double> freqs2;
+        rpm::vector<double> power;
+        rpm::vector<double> arPower;
+        rpm::vector<double> lpc;
+        rpm::vector<double> errors;
+        rpm::vector<double> r;
+    };
+
+    /*
+     *  Built-in forward pass of the DeepFormants network, a stack of dense
+     *  layers read from the flat binary written by resources/convert-model.py.
+     *
+     *  The weights are used in place from the mapped file or Qt resource,
+     *  only the activations of one batch are allocated.
+     *
+     *  With Int8, the weights are quantized at load time, symmetric per
+     *  output, and each row of activations is quantized on the fly before
+     *  every layer. Products accumulate in 32 bit integers.
+     */
+    class DenseNetwork {
+    public:
+        enum class Precision {
+            Float32,
+            Int8,
+        };
+
+        DenseNetwork(const QString& path, Precision precision = Precision::Float32);
+
+        int getInputLength() const;
+        int getOutputLength() const;
+        Precision getPrecision() const;
+
+        // rows of getInputLength() floats in, rows of getOutputLength() floats out.
+        void forward(const float *x, int rows, float *y);
+
+    private:
+        struct Layer {
+            int inputs;
+            int outputs;
+            bool sigmoid;
+            const float *weights;
+            const float *bias;
+            // Int8 only.
+            const int8_t *qweights;
+            const float *scales;
+        };
+
+        void quantize();
+        void denseInt8(const Layer& layer, const float *x, int rows, float *y);
+
+        Precision precision;
+
+        QFile file;
+        QByteArray copy;
+        // Holds the file when it can't be read as floats in place.
+        rpm::vector<float> aligned;
+
+        rpm::vector<Layer> layers;
+        rpm::vector<float> activations[2];
+
+        rpm::vector<int8_t> qweights;
+        rpm::vector<float> scales;
+        rpm::vector<int16_t> qinput;
+        rpm::vector<float> inputScales;
+    };
+
+}
 
 #endif // DEEP_FORMANTS_H
@@ -1,241 +1,163 @@
 #include "df.h"
-#include "../../fft/fft.h"
 #include "../../linpred/linpred.h"
-#include <memory>
+#include <cmath>
+#include <stdexcept>
 
-using namespace Eigen;
+using namespace Analysis::Formant;
 
-static int sDctN = 0;
-static std::unique_ptr<Analysis::ReReFFT> sDct;
+static constexpr int ncep_ar = 30;
+static constexpr int ncep_ps = 50;
 
-static int sFft1N = 0;
-static std::unique_ptr<Analysis::RealFFT> sFft1;
+static constexpr int nfft = 4096;
+static constexpr int pn = nfft / 2 + 1;
 
-static int sFft2N = 0;
-static std::unique_ptr<Analysis::RealFFT> sFft2;
+static constexpr int minOrder = 8;
+static constexpr int maxOrder = 17;
+static constexpr int numOrders = maxOrder - minOrder + 1;
 
-template<typename Derived>
-static ArrayXd dct(const ArrayBase<Derived>& x, int trunc)
-{
-    const int N = x.size();
-    
-    if (sDctN != N) {
-        sDctN = N;
-        sDct = std::make_unique<Analysis::ReReFFT>(N, FFTW_REDFT10);
-    }
-    auto& dct = *sDct;
-
-    for (int i = 0; i < N; ++i) {
-        dct.data(i) = x(i);
-    }
-    dct.compute();
+static constexpr int pitch = 50;
 
-    ArrayXd out(trunc);
-    out(0) = dct.data(0) / sqrt(4 * N);
-    for (int i = 1; i < trunc; ++i) {
-        out(i) = dct.data(i);
-    }
-    return out;
-}
+static constexpr double epsilon = 1e-10;
 
-template<typename Derived>
-static ArrayXd feature_periodogram(const ArrayBase<Derived>& x, int nfft)
+static_assert(FeatureExtractor::numFeatures == ncep_ps + numOrders * ncep_ar);
+
+FeatureExtractor::FeatureExtractor()
+    : fftPs(nfft),
+      fftAr(nfft, numOrders),
+      dct(pn, FFTW_REDFT10),
+      freqs2(pn),
+      power(pn),
+      arPower(numOrders * pn),
+      lpc(maxOrder * maxOrder),
+      errors(maxOrder + 1),
+      r(maxOrder + 1)
 {
-    const int N = x.size();
-
-    if (sFft1N != nfft) {
-        sFft1N = nfft;
-        sFft1 = std::make_unique<Analysis::RealFFT>(nfft);
-    }
-    auto& fft = *sFft1;
-    
-    if (N < nfft) {
-        for (int i = 0; i < nfft; ++i)
-            fft.input(i) = 0.0;
-        for (int i = 0; i < N; ++i) 
-            fft.input(nfft / 2 - N / 2 + i) = x(i);
-    }
-    else if (N > nfft) {
-        for (int i = 0; i < nfft; ++i) {
-            fft.input(i) = x(N / 2 - nfft / 2 + i);
-        }
+    // Squared normalized frequencies, 0 to 0.5.
+    for (int i = 0; i < pn; ++i) {
+        const double f = 0.5 * i / (pn - 1);
+        freqs2[i] = f * f;
     }
-    else {
+
+    for (int j = 0; j < numOrders; ++j) {
         for (int i = 0; i < nfft; ++i) {
-            fft.input(i) = x(i);
+            fftAr.input(j, i) = 0.0;
         }
     }
-
-    fft.computeForward();
-
-    int outLength = fft.getOutputLength();
-    ArrayXd out(outLength);
-    for (int i = 0; i < outLength; ++i) {
-        double px = std::abs(fft.output(i));
-        out(i) = (px * px) / N;
-    }
-    return out;
 }
 
-template<typename Derived>
-static ArrayXd feature_arspec(const ArrayBase<Derived>& x, int order, int nfft)
+void FeatureExtractor::compute(const double *x, int length, float *out)
 {
-    Analysis::LP::Autocorr lpc;
-    double e;
-    rpm::vector<double> xv(x.size());
-    for (int i = 0; i < x.size(); ++i)
-        xv[i] = x(i);
-    auto a = lpc.solve(xv.data(), xv.size(), order, &e);
-
-    if (sFft2N != nfft) {
-        sFft2N = nfft;
-        sFft2 = std::make_unique<Analysis::RealFFT>(nfft);
+    if (length < maxOrder + 1) {
+        throw std::runtime_error("Formant::FeatureExtractor] Frame is too short");
     }
-    auto& fft = *sFft2;
 
-    fft.input(0) = 1.0;
-    for (int i = 1; i <= a.size(); ++i) 
-        fft.input(i) = a[i - 1];
-    for (int i = a.size() + 1; i < nfft; ++i)
-        fft.input(i) = 0.0; 
+    periodogram(x, length);
+
+    // Every LPC order shares the autocorrelation of the frame. The features
+    // expect data in 16 bit signed int format.
+    Eigen::Map<const Eigen::VectorXd> xv(x, length);
+    for (int k = 0; k <= maxOrder; ++k) {
+        r[k] = xv.head(length - k).dot(xv.tail(length - k)) * (MAX_AMPLITUDE_16BIT * MAX_AMPLITUDE_16BIT);
+    }
 
-    fft.computeForward();
+    arSpectra(r.data());
 
-    int outLength = fft.getOutputLength();
-    ArrayXd out(outLength);
-    for (int i = 0; i < outLength; ++i) {
-        auto px = std::abs(1.0 / fft.output(i));
-        out(i) = px * px * e;
+    for (int i = 0; i < pn; ++i) {
+        double peri = std::sqrt(power[i] * power[i] + freqs2[i]);
+        if (peri > 0.0)
+            peri = std::log(peri);
+        else if (peri == 0.0)
+            peri = epsilon;
+        else
+            peri = NAN;
+        dct.data(i) = std::log10(peri);
+    }
+    cepstrum(ncep_ps, out);
+
+    for (int j = 0; j < numOrders; ++j) {
+        const double *ars = arPower.data() + j * pn;
+        for (int i = 0; i < pn; ++i) {
+            double ar = std::log(std::sqrt(ars[i] * ars[i] + freqs2[i]));
+            if (ar < 0.0)
+                ar = NAN;
+            else if (ar == 0.0)
+                ar = epsilon;
+            dct.data(i) = std::log10(ar);
+        }
+        cepstrum(ncep_ar, out + ncep_ps + j * ncep_ar);
     }
-    return out;
 }
 
-template<typename Derived>
-static ArrayXd atal(const ArrayBase<Derived>& x, int order, int numCoefs)
+// Average of the periodograms of about pitch segments, each centred in the transform.
+void FeatureExtractor::periodogram(const double *x, int length)
 {
-    Analysis::LP::Autocorr lpc;
-    double e;
-    rpm::vector<double> xv(x.size());
-    for (int i = 0; i < x.size(); ++i)
-        xv[i] = x(i);
-    auto a = lpc.solve(xv.data(), xv.size(), order, &e);
-    int m, k, p = a.size();
-
-    ArrayXd c(numCoefs);
-    c.setZero();
-    
-    c(0) = 1.0;
-    for (m = 1; m < p + 1; ++m) {
-        c(m) = -a[m - 1];
-        for (k = 1; k < m; ++k)
-            c(m) += (double(k) / double(m) - 1) * a[k - 1] * c(m - k);
-    }
-    for (m = p + 1; m < numCoefs; ++m) {
-        c(m) = 0.0;
-        for (k = 1; k < p + 1; ++k)
-            c(m) += (double(k) / double(m) - 1) * a[k - 1] * c(m - k);
-    }
-    return c;
-}
+    int samps = length / pitch;
+    if (samps == 0)
+        samps = 1;
+    const int frames = length / samps;
 
-static constexpr int ncep_ar = 30;
-static constexpr int ncep_ps = 50;
+    std::fill(power.begin(), power.end(), 0.0);
 
-static constexpr int nfft_ar = 4096;
-static constexpr int nfft_ps = 4096;
+    for (int s = 0; s < samps; ++s) {
+        const double *seg = x + s * frames;
 
-static constexpr double epsilon = 1e-10;
+        for (int i = 0; i < nfft; ++i)
+            fftPs.input(i) = 0.0;
 
-template<typename Derived>
-static ArrayXd arSpecs(const ArrayBase<Derived>& x, int order)
-{
-    //return atal(x, order, ncep_ar);
+        if (frames < nfft) {
+            for (int i = 0; i < frames; ++i)
+                fftPs.input(nfft / 2 - frames / 2 + i) = seg[i] * MAX_AMPLITUDE_16BIT;
+        }
+        else {
+            for (int i = 0; i < nfft; ++i)
+                fftPs.input(i) = seg[frames / 2 - nfft / 2 + i] * MAX_AMPLITUDE_16BIT;
+        }
 
-    static constexpr int nfft = nfft_ar;
-    static constexpr int pn = nfft / 2 + 1;
+        fftPs.computeForward();
 
-    static ArrayXd freqs;
-    if (freqs.size() != pn) {
-        freqs.setLinSpaced(pn, 0, 0.5);
+        for (int i = 0; i < pn; ++i)
+            power[i] += std::norm(fftPs.output(i)) / frames;
     }
 
-    ArrayXd ars = feature_arspec(x, order, nfft);
-    ArrayXd ar(pn);
-
-    for (int i = 0; i < pn; ++i) {
-        ar(i) = log(sqrt(ars(i) * ars(i) + freqs(i) * freqs(i)));
-        
-        if (ar(i) < 0.0)
-            ar(i) = NAN;
-        else if (ar(i) == 0.0)
-            ar(i) = epsilon;
-    }
-   
-    return dct(log10(ar), ncep_ar);
+    for (int i = 0; i < pn; ++i)
+        power[i] /= samps;
 }
 
-template<typename Derived>
-static ArrayXd specPS(const ArrayBase<Derived>& x, int pitch)
+// All orders come out of one Levinson recursion and one batched transform.
+void FeatureExtractor::arSpectra(const double *r)
 {
-    static constexpr int nfft = nfft_ps;
-    static constexpr int pn = nfft / 2 + 1;
+    Analysis::LP::levinsonOrders(r, maxOrder, lpc.data(), errors.data());
 
-    static ArrayXd freqs;
-    if (freqs.size() != pn) {
-        freqs.setLinSpaced(pn, 0, 0.5);
-    }
+    for (int j = 0; j < numOrders; ++j) {
+        const int order = minOrder + j;
+        const double *a = lpc.data() + (order - 1) * maxOrder;
 
-    int samps = x.size() / pitch;
-    if (samps == 0)
-        samps = 1;
-    int frames = x.size() / samps;
-
-    ArrayXd specs = feature_periodogram(x.head(frames), nfft);
-    for (int i = 1; i < samps; ++i) {
-        specs += feature_periodogram(x.segment(i * frames, frames), nfft);
+        fftAr.input(j, 0) = 1.0;
+        for (int i = 1; i <= order; ++i)
+            fftAr.input(j, i) = a[i - 1];
     }
-    specs /= (double) samps;
 
-    ArrayXd peri(pn);
+    fftAr.computeForward();
 
-    for (int i = 0; i < pn; ++i) {
-        peri(i) = sqrt(specs(i) * specs(i) + freqs(i) * freqs(i));
-        if (peri(i) > 0.0)
-            peri(i) = log(peri(i));
-        else if (peri(i) == 0.0)
-            peri(i) = epsilon;
-        else
-            peri(i) = NAN;
+    for (int j = 0; j < numOrders; ++j) {
+        const double e = errors[minOrder + j];
+        double *ars = arPower.data() + j * pn;
+        for (int i = 0; i < pn; ++i)
+            ars[i] = e / std::norm(fftAr.output(j, i));
     }
-   
-    return dct(log10(peri), ncep_ps);
 }
 
-template<typename Derived>
-ArrayXd build_feature_row(const ArrayBase<Derived>& x)
+// Truncated DCT-II of what compute() left in the transform, with NaNs zeroed.
+void FeatureExtractor::cepstrum(int numCoefs, float *out)
 {
-    const rpm::vector<int> lpcs{8, 9, 10, 11, 12, 13, 14, 15, 16, 17};
-    
-    // The feature things expect data in 16bit signed int format.
-    ArrayXd input = x * MAX_AMPLITUDE_16BIT;
-    
-    ArrayXd arr(ncep_ps + lpcs.size() * ncep_ar);
-
-    arr.head(ncep_ps) = specPS(input, 50);
-
-    int start = ncep_ps;
-    for (int order : lpcs) {
-        arr.segment(start, ncep_ar) = arSpecs(input, order);
-        start += ncep_ar;
-    }
+    dct.compute();
 
-    for (int i = 0; i < arr.size(); ++i) {
-        if (std::isnan(arr(i)))
-            arr(i) = 0.0;
-    }
+    out[0] = dct.data(0) / std::sqrt(4 * pn);
+    for (int i = 1; i < numCoefs; ++i)
+        out[i] = dct.data(i);
 
-    return arr;
+    for (int i = 0; i < numCoefs; ++i) {
+        if (std::isnan(out[i]))
+            out[i] = 0.0f;
+    }
 }
-
-using ImplT = Map<const ArrayXd>;
-template ArrayXd build_feature_row<ImplT>(const ArrayBase<ImplT>& x);
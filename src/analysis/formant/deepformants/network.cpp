@@ -0,0 +1,238 @@
+#include "df.h"
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+using namespace Analysis::Formant;
+
+using RowMatrix = Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
+
+static constexpr char magic[4] = { 'D', 'F', 'N', 'N' };
+static constexpr uint32_t version = 1;
+
+static constexpr int headerSize = 16;
+static constexpr int layerSize = 16;
+
+static constexpr uint32_t activationNone = 0;
+static constexpr uint32_t activationSigmoid = 1;
+
+// exp() of anything larger overflows float, and with -ffast-math 1/inf is not 0.
+static constexpr float maxLogit = 80.0f;
+
+static uint32_t readU32(const uchar *p)
+{
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t) p[3] << 24);
+}
+
+// Symmetric int8 quantization of n values, returns the scale.
+template<typename T>
+static float quantizeRow(const float *x, int n, T *q)
+{
+    float maxAbs = 0.0f;
+    for (int i = 0; i < n; ++i)
+        maxAbs = std::max(maxAbs, std::abs(x[i]));
+
+    if (maxAbs == 0.0f) {
+        std::fill(q, q + n, 0);
+        return 1.0f;
+    }
+
+    const float scale = maxAbs / 127.0f;
+    const float invScale = 1.0f / scale;
+    for (int i = 0; i < n; ++i)
+        q[i] = (T) std::lrint(x[i] * invScale);
+    return scale;
+}
+
+// Activations hold int8 values widened to 16 bits, so that compilers turn this
+// plain loop into 16 bit multiply-adds (pmaddwd and the like).
+static int32_t dotInt8(const int16_t *a, const int8_t *w, int n)
+{
+    int32_t sum = 0;
+    for (int i = 0; i < n; ++i)
+        sum += a[i] * (int16_t) w[i];
+    return sum;
+}
+
+DenseNetwork::DenseNetwork(const QString& path, Precision precision)
+    : precision(precision),
+      file(path)
+{
+    if (!file.open(QIODevice::ReadOnly)) {
+        throw std::runtime_error("Formant::DenseNetwork] Could not open " + path.toStdString());
+    }
+
+    const qint64 size = file.size();
+
+    // Compressed resources can't be mapped, those get decompressed once.
+    uchar *mapped = file.map(0, size);
+    const uchar *data = mapped;
+    if (data == nullptr) {
+        copy = file.readAll();
+        data = reinterpret_cast<const uchar *>(copy.constData());
+    }
+
+    // Resources sit at arbitrary offsets in the rcc blob, but the weights are read as floats.
+    if (reinterpret_cast<uintptr_t>(data) % alignof(float) != 0) {
+        aligned.resize((size + sizeof(float) - 1) / sizeof(float));
+        std::memcpy(aligned.data(), data, size);
+        data = reinterpret_cast<const uchar *>(aligned.data());
+
+        if (mapped != nullptr) {
+            file.unmap(mapped);
+        }
+        copy.clear();
+    }
+
+    if (size < headerSize || std::memcmp(data, magic, 4) != 0) {
+        throw std::runtime_error("Formant::DenseNetwork] Not a network file");
+    }
+    if (readU32(data + 4) != version) {
+        throw std::runtime_error("Formant::DenseNetwork] Unsupported network file version");
+    }
+
+    const uint32_t count = readU32(data + 8);
+    if (count == 0 || size < headerSize + (qint64) count * layerSize) {
+        throw std::runtime_error("Formant::DenseNetwork] Truncated network file");
+    }
+
+    layers.resize(count);
+
+    for (uint32_t l = 0; l < count; ++l) {
+        const uchar *p = data + headerSize + l * layerSize;
+        const uint32_t inputs = readU32(p);
+        const uint32_t outputs = readU32(p + 4);
+        const uint32_t activation = readU32(p + 8);
+        const uint32_t offset = readU32(p + 12);
+
+        // The bias starts on the next 64 byte boundary after the weights.
+        const qint64 biasOffset = (offset + 4 * (qint64) inputs * outputs + 63) / 64 * 64;
+
+        if (inputs == 0 || outputs == 0 || offset % 4 != 0 || biasOffset + 4 * (qint64) outputs > size) {
+            throw std::runtime_error("Formant::DenseNetwork] Truncated network file");
+        }
+        if (l > 0 && (int) inputs != layers[l - 1].outputs) {
+            throw std::runtime_error("Formant::DenseNetwork] Layer sizes do not match");
+        }
+        if (activation != activationNone && activation != activationSigmoid) {
+            throw std::runtime_error("Formant::DenseNetwork] Unknown activation");
+        }
+
+        layers[l] = {
+            .inputs = (int) inputs,
+            .outputs = (int) outputs,
+            .sigmoid = (activation == activationSigmoid),
+            .weights = reinterpret_cast<const float *>(data + offset),
+            .bias = reinterpret_cast<const float *>(data + biasOffset),
+            .qweights = nullptr,
+            .scales = nullptr,
+        };
+    }
+
+    if (precision == Precision::Int8) {
+        quantize();
+    }
+}
+
+int DenseNetwork::getInputLength() const
+{
+    return layers.front().inputs;
+}
+
+int DenseNetwork::getOutputLength() const
+{
+    return layers.back().outputs;
+}
+
+DenseNetwork::Precision DenseNetwork::getPrecision() const
+{
+    return precision;
+}
+
+void DenseNetwork::forward(const float *x, int rows, float *y)
+{
+    const float *in = x;
+
+    for (int l = 0; l < (int) layers.size(); ++l) {
+        const Layer& layer = layers[l];
+
+        float *out = y;
+        if (l + 1 < (int) layers.size()) {
+            activations[l % 2].resize(rows * layer.outputs);
+            out = activations[l % 2].data();
+        }
+
+        Eigen::Map<RowMatrix> Y(out, rows, layer.outputs);
+
+        if (precision == Precision::Int8) {
+            denseInt8(layer, in, rows, out);
+        }
+        else {
+            Eigen::Map<const RowMatrix> X(in, rows, layer.inputs);
+            Eigen::Map<const RowMatrix> W(layer.weights, layer.outputs, layer.inputs);
+            Eigen::Map<const Eigen::RowVectorXf> b(layer.bias, layer.outputs);
+
+            // A single frame, the live case, is a matrix-vector product over contiguous weight rows.
+            if (rows == 1) {
+                Y.row(0).transpose().noalias() = W * X.row(0).transpose();
+            }
+            else {
+                Y.noalias() = X * W.transpose();
+            }
+            Y.rowwise() += b;
+        }
+
+        if (layer.sigmoid) {
+            Y = (1.0f + (-Y.array().max(-maxLogit).min(maxLogit)).exp()).inverse().matrix();
+        }
+
+        in = out;
+    }
+}
+
+void DenseNetwork::quantize()
+{
+    int weightCount = 0;
+    int outputCount = 0;
+    for (const auto& layer : layers) {
+        weightCount += layer.inputs * layer.outputs;
+        outputCount += layer.outputs;
+    }
+
+    qweights.resize(weightCount);
+    scales.resize(outputCount);
+
+    int8_t *q = qweights.data();
+    float *scale = scales.data();
+
+    for (auto& layer : layers) {
+        for (int j = 0; j < layer.outputs; ++j) {
+            scale[j] = quantizeRow(layer.weights + j * layer.inputs, layer.inputs, q + j * layer.inputs);
+        }
+        layer.qweights = q;
+        layer.scales = scale;
+
+        q += layer.inputs * layer.outputs;
+        scale += layer.outputs;
+    }
+}
+
+void DenseNetwork::denseInt8(const Layer& layer, const float *x, int rows, float *y)
+{
+    const int n = layer.inputs;
+
+    qinput.resize(rows * n);
+    inputScales.resize(rows);
+    for (int r = 0; r < rows; ++r) {
+        inputScales[r] = quantizeRow(x + r * n, n, qinput.data() + r * n);
+    }
+
+    for (int r = 0; r < rows; ++r) {
+        const int16_t *a = qinput.data() + r * n;
+        for (int j = 0; j < layer.outputs; ++j) {
+            const int32_t acc = dotInt8(a, layer.qweights + j * n, n);
+            y[r * layer.outputs + j] = acc * (inputScales[r] * layer.scales[j]) + layer.bias[j];
+        }
+    }
+}
@@ -0,0 +1,95 @@
+#include "formant.h"
+#include "../util/util.h"
+#include "../util/parallel.h"
+
+using namespace Analysis::Formant;
+using Analysis::FormantResult;
+
+// Distance in bins from the peak down to where the envelope crosses level,
+// or -1 if it turns back up (or runs out) before getting there.
+static double halfWidth(const rpm::vector<double>& envelope, int peak, double level, int dir)
+{
+    const int last = envelope.size() - 1;
+
+    for (int k = peak + dir; k >= 0 && k <= last; k += dir) {
+        if (envelope[k] <= level) {
+            const double y0 = envelope[k - dir];
+            const double y1 = envelope[k];
+            return std::abs(k - peak) - (level - y1) / (y0 - y1);
+        }
+        if (envelope[k] > envelope[k - dir]) {
+            break;
+        }
+    }
+
+    return -1;
+}
+
+EnvelopeLP::EnvelopeLP(int nfft)
+    : nfft(nfft),
+      response(nfft),
+      envelope(response.getLength())
+{
+}
+
+FormantResult EnvelopeLP::solve(const double *lpc, int lpcOrder, double sampleRate)
+{
+    return solve(lpc, lpcOrder, sampleRate, response, envelope);
+}
+
+FormantResult EnvelopeLP::solve(const double *lpc, int lpcOrder, double sampleRate, FrequencyResponse& response, rpm::vector<double>& envelope)
+{
+    const int nout = response.getLength();
+
+    response.lpc(lpc, lpcOrder, 1.0, 0, nout, envelope.data());
+
+    for (int k = 0; k < nout; ++k)
+        envelope[k] = 20.0 * std::log10(std::min(envelope[k], 1e15));
+
+    FormantResult result;
+
+    const double binWidth = sampleRate / (2 * (nout - 1));
+
+    // The envelope is smooth, any peak standing 1 dB above its surroundings is kept.
+    for (int peak : findPeaks(envelope.data(), nout, +1, 1.0)) {
+        if (peak < 1 || peak >= nout - 1) continue;
+
+        const auto [position, value] = parabolicInterpolation(envelope, peak);
+        const double frequency = position * binWidth;
+
+        if (frequency < 50.0 || frequency > sampleRate / 2.0 - 50.0) {
+            continue;
+        }
+
+        // Bandwidth from the -3 dB points, mirrored when only one side reaches down.
+        const double left = halfWidth(envelope, peak, value - 3.0, -1);
+        const double right = halfWidth(envelope, peak, value - 3.0, +1);
+
+        double width;
+        if (left >= 0 && right >= 0)
+            width = left + right;
+        else if (left >= 0 || right >= 0)
+            width = 2.0 * std::max(left, right);
+        else
+            continue;
+
+        result.formants.push_back({
+            .frequency = frequency,
+            .bandwidth = width * binWidth,
+        });
+    }
+
+    sortFormants(result.formants);
+
+    return result;
+}
+
+void EnvelopeLP::solveBatch(const double *lpc, int count, int lpcOrder, double sampleRate, FormantResult *results)
+{
+    parallelFor(count, [&](int begin, int end) {
+        FrequencyResponse response(nfft);
+        rpm::vector<double> envelope(response.getLength());
+        for (int i = begin; i < end; ++i)
+            results[i] = solve(lpc + i * lpcOrder, lpcOrder, sampleRate, response, envelope);
+    });
+}
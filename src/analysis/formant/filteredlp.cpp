@@ -1,5 +1,6 @@
 #include "formant.h"
 #include "../util/util.h"
+#include "../util/parallel.h"
 #include "../util/laguerre.h"
 #include "../fft/fft.h"
 #include <algorithm>
@@ -12,12 +13,17 @@ static int cauchyIntegral(const rpm::vector<double>& p, double r1, double r2, do
 static rpm::vector<int> peak_picking(const rpm::vector<double> &nsdf);
 
 FormantResult FilteredLP::solve(const double *lpc, int lpcOrder, double sampleRate)
+{
+    return solve(lpc, lpcOrder, sampleRate, tracker);
+}
+
+FormantResult FilteredLP::solve(const double *lpc, int lpcOrder, double sampleRate, RootTracker& tracker)
 {
     rpm::vector<double> polynomial(lpcOrder + 1);
     polynomial[0] = 1.0;
     std::copy(lpc, lpc + lpcOrder, std::next(polynomial.begin()));
 
-    rpm::vector<std::complex<double>> roots = findRoots(polynomial);
+    rpm::vector<std::complex<double>> roots = tracker.solve(polynomial);
     
     struct FormantRoot {
         FormantData d;
@@ -117,6 +123,20 @@ FormantResult FilteredLP::solve(const double *lpc, int lpcOrder, double sampleRa
     return result;
 }
 
+void FilteredLP::reset()
+{
+    tracker.reset();
+}
+
+void FilteredLP::solveBatch(const double *lpc, int count, int lpcOrder, double sampleRate, FormantResult *results)
+{
+    parallelFor(count, [&](int begin, int end) {
+        RootTracker tracker;
+        for (int i = begin; i < end; ++i)
+            results[i] = solve(lpc + i * lpcOrder, lpcOrder, sampleRate, tracker);
+    });
+}
+
 static void snellCalcRegion(double t, rpm::map<double, int>& C, const rpm::vector<double>& p, double phi)
 {
     // Do not calculate again.
@@ -3,15 +3,19 @@
 
 #include "rpcxx.h"
 #include "../../modules/audio/resampler/resampler.h"
+#include "../freqz/freqz.h"
+#include "../util/root_tracker.h"
 
 #ifdef _WIN32
 extern "C" void __assert_fail(const char* expr, const char *filename, unsigned int line, const char *assert_func) noexcept;
 #endif
 
+#ifdef WITH_TORCH
 #undef slots
 #undef ERROR
 #include <torch/script.h>
 #define slots Q_SLOTS
+#endif
 
 namespace Analysis {
 
@@ -28,17 +32,53 @@ namespace Analysis {
     public:
         virtual ~FormantSolver() {}
         virtual FormantResult solve(const double *lpc, int lpcOrder, double sampleRate) = 0;
+
+        // Drops any state carried over from previously solved frames.
+        virtual void reset() {}
+
+        // Row i of lpc (lpcOrder values) holds the coefficients of frame i, as written by
+        // LinpredSolver::solveBatch.
+        virtual void solveBatch(const double *lpc, int count, int lpcOrder, double sampleRate, FormantResult *results)
+        {
+            for (int i = 0; i < count; ++i)
+                results[i] = solve(lpc + i * lpcOrder, lpcOrder, sampleRate);
+        }
     };
 
     namespace Formant {
         class SimpleLP : public FormantSolver {
         public:
             FormantResult solve(const double *lpc, int lpcOrder, double sampleRate) override;
+            void solveBatch(const double *lpc, int count, int lpcOrder, double sampleRate, FormantResult *results) override;
+            void reset() override;
+        private:
+            // Roots are tracked from frame to frame, batches use one tracker per worker.
+            static FormantResult solve(const double *lpc, int lpcOrder, double sampleRate, RootTracker& tracker);
+            RootTracker tracker;
         };
 
         class FilteredLP : public FormantSolver {
         public:
             FormantResult solve(const double *lpc, int lpcOrder, double sampleRate) override;
+            void solveBatch(const double *lpc, int count, int lpcOrder, double sampleRate, FormantResult *results) override;
+            void reset() override;
+        private:
+            // Roots are tracked from frame to frame, batches use one tracker per worker.
+            static FormantResult solve(const double *lpc, int lpcOrder, double sampleRate, RootTracker& tracker);
+            RootTracker tracker;
+        };
+
+        // Picks the peaks of the LPC envelope sampled by one zero-padded FFT, no root finding.
+        class EnvelopeLP : public FormantSolver {
+        public:
+            EnvelopeLP(int nfft = 1024);
+            FormantResult solve(const double *lpc, int lpcOrder, double sampleRate) override;
+            void solveBatch(const double *lpc, int count, int lpcOrder, double sampleRate, FormantResult *results) override;
+        private:
+            static FormantResult solve(const double *lpc, int lpcOrder, double sampleRate, FrequencyResponse& response, rpm::vector<double>& envelope);
+            int nfft;
+            FrequencyResponse response;
+            rpm::vector<double> envelope;
         };
         
         struct KarmaState;
@@ -48,17 +88,38 @@ namespace Analysis {
             Karma();
             ~Karma();
             FormantResult solve(const double *lpc, int lpcOrder, double sampleRate) override;
+            void reset() override;
+            // Offline: filters the whole batch from the initial prior, then runs a
+            // Rauch-Tung-Striebel smoother back over it. The state used by solve() is untouched.
+            void smooth(const double *lpc, int count, int lpcOrder, double sampleRate, FormantResult *results) const;
         private:
             KarmaState *state;
         };
 
+        class FeatureExtractor;
+        class DenseNetwork;
+
         class DeepFormants : public FormantSolver {
         public:
-            DeepFormants();
+            // Runs the built-in engine on model.bin, or model.pt through libtorch when built WITH_TORCH.
+            // Intra-op threads are a libtorch wide setting, 0 keeps its default.
+            // Quantized always runs the built-in engine with int8 weights and activations.
+            DeepFormants(int intraOpThreads = 0, bool quantized = false);
+            ~DeepFormants();
             FormantResult solve(const double *lpc, int lpcOrder, double sampleRate) override;
             void setFrameAudio(const rpm::vector<double>& x);
+            // Rows of length samples, stride apart, prepared like the audio for setFrameAudio.
+            // All rows go through the model together.
+            void solveFrames(const double *frames, int count, int length, int stride, FormantResult *results);
         private:
+            static constexpr int maxBatch = 256;
+#ifdef WITH_TORCH
             torch::jit::script::Module module;
+#endif
+            std::unique_ptr<DenseNetwork> network;
+            rpm::vector<float> predictions;
+            std::unique_ptr<FeatureExtractor> extractor;
+            rpm::vector<float> features;
             rpm::vector<double> xv;
             double fs;
         };
@@ -6,40 +6,52 @@ using Analysis::FormantResult;
 
 using namespace Eigen;
 
+constexpr int ncep = 15;
+constexpr int numF = 3;
+constexpr int numS = 2 * numF;
+
+using StateVector = Matrix<double, numS, 1>;
+using StateMatrix = Matrix<double, numS, numS>;
+using CepVector = Matrix<double, ncep, 1>;
+using CepMatrix = Matrix<double, ncep, numS>;
+using CepCovariance = Matrix<double, ncep, ncep>;
+
+// The state transition is the identity, a random walk on frequencies and bandwidths.
 struct Analysis::Formant::KarmaState
 {
-    int numF;
-    VectorXd y;
-    MatrixXd F;
-    MatrixXd Q;
-    MatrixXd R;
-    VectorXd m_up;
-    VectorXd P_up;
+    struct Step {
+        StateVector m_pred;
+        StateMatrix P_pred;
+        StateVector m_up;
+        StateMatrix P_up;
+    };
+
+    StateMatrix Q;
+    CepCovariance R;
+    StateVector m_up;
+    StateMatrix P_up;
 };
 
-constexpr int ncep = 15;
-constexpr int numF = 3;
+static void setPrior(KarmaState& state);
+static void calcCepstrumCoefs(const double *lpc, int lpcOrder, CepVector& C);
+static void calcCepstrumModel(const StateVector& m, double Fs, CepVector& C, CepMatrix& H);
+static void predict(KarmaState& state);
+static void update(KarmaState& state, const double *lpc, int lpcOrder, double sampleRate);
+static FormantResult stateToResult(const StateVector& m);
 
 Karma::Karma()
     : state(new KarmaState)
 {
-    state->F.setIdentity(2 * numF, 2 * numF);
+    state->Q.setZero();
+    state->Q.diagonal().head<numF>().setConstant(320 * 320);
+    state->Q.diagonal().tail<numF>().setConstant(100 * 100);
 
-    state->Q.setZero(2 * numF, 2 * numF);
-    state->Q.diagonal().head(numF).setConstant(320 * 320);
-    state->Q.diagonal().tail(numF).setConstant(100 * 100);
-    
-    state->R.setZero(ncep, ncep);
+    state->R.setZero();
     for (int i = 0; i < ncep; ++i) {
         state->R(i, i) = 1.0 / (double) (i + 1);
     }
 
-    VectorXd x0(2 * numF);
-    x0 << 500, 1500, 2500,
-           80,  120,  160;
-
-    state->m_up = x0;
-    state->P_up = state->Q;
+    reset();
 }
 
 Karma::~Karma()
@@ -47,104 +59,135 @@ Karma::~Karma()
     delete state;
 }
 
-static VectorXd calcCepstrumCoefs(const double *lpc, int lpcOrder, int ncep);
-static MatrixXd calcMatrixH(const VectorXd& m, int cepOrder, double Fs);
-static VectorXd calcCepstrumMapping(const VectorXd& m, int cepOrder, double Fs);
+void Karma::reset()
+{
+    setPrior(*state);
+}
 
 FormantResult Karma::solve(const double *lpc, int lpcOrder, double sampleRate)
 {
-    auto& F  = state->F;
-    auto  Ft = state->F.transpose();
-    auto& Q  = state->Q;
-    auto& R  = state->R;
+    predict(*state);
+    update(*state, lpc, lpcOrder, sampleRate);
+    return stateToResult(state->m_up);
+}
+
+void Karma::smooth(const double *lpc, int count, int lpcOrder, double sampleRate, FormantResult *results) const
+{
+    // A filter of its own, the live state is left as it was.
+    KarmaState filter;
+    filter.Q = state->Q;
+    filter.R = state->R;
+    setPrior(filter);
+
+    rpm::vector<KarmaState::Step> steps(count);
+
+    for (int t = 0; t < count; ++t) {
+        predict(filter);
+        steps[t].m_pred = filter.m_up;
+        steps[t].P_pred = filter.P_up;
+
+        update(filter, lpc + t * lpcOrder, lpcOrder, sampleRate);
+        steps[t].m_up = filter.m_up;
+        steps[t].P_up = filter.P_up;
+    }
 
-    auto m_pred = F * state->m_up;
-    auto P_pred = F * state->P_up * Ft + Q;
+    if (count == 0)
+        return;
 
-    auto H  = calcMatrixH(m_pred, ncep, sampleRate);
-    auto Ht = H.transpose();
-   
-    auto S = H * P_pred * Ht + R;
-    auto K = (P_pred * Ht) * S.colPivHouseholderQr().inverse();
+    // Rauch-Tung-Striebel pass, from the last frame back.
+    StateVector m_s = steps[count - 1].m_up;
+    StateMatrix P_s = steps[count - 1].P_up;
+    results[count - 1] = stateToResult(m_s);
 
-    auto y_pred = calcCepstrumMapping(m_pred, ncep, sampleRate);
-    auto y      = calcCepstrumCoefs(lpc, lpcOrder, ncep);
+    for (int t = count - 2; t >= 0; --t) {
+        const auto& cur = steps[t];
+        const auto& next = steps[t + 1];
 
-    state->m_up = m_pred + K * (y - y_pred);
-    state->P_up = P_pred - K * H * P_pred;
+        // G = P_up P_pred^-1, both symmetric.
+        const StateMatrix G = next.P_pred.llt().solve(cur.P_up).transpose();
 
-    rpm::vector<FormantData> formants(numF);
-    for (int i = 0; i < numF; ++i) {
-        formants[i] = {
-            .frequency = state->m_up(i),
-            .bandwidth = state->m_up(numF + i),
-        };
+        m_s = cur.m_up + G * (m_s - next.m_pred);
+        P_s = cur.P_up + G * (P_s - next.P_pred) * G.transpose();
+
+        results[t] = stateToResult(m_s);
     }
+}
 
-    return { .formants = formants };
+static void setPrior(KarmaState& state)
+{
+    state.m_up << 500, 1500, 2500,
+                   80,  120,  160;
+    state.P_up = state.Q;
 }
 
-VectorXd calcCepstrumCoefs(const double *lpc, int lpcOrder, int ncep)
+static void predict(KarmaState& state)
 {
-    VectorXd C(ncep);
+    state.P_up += state.Q;
+}
 
-    for (int n = 1; n <= ncep; ++n) {
-        if (n == 1) {
-            C(n - 1) = lpc[n - 1];
-        }
-        else if (n <= lpcOrder) {
-            C(n - 1) = lpc[n - 1];
-            for (int i = 1; i <= ncep - 1; ++i) {
-                C(n - 1) += (double) i / (double) n * lpc[n - i - 1] * C(i - 1);
-            }
-        }
-        else {
-            C(n - 1) = 0.0;
-            for (int i = ncep - lpcOrder; i <= ncep - 1; ++i) {
-                C(n - 1) += (double) i / (double) n * lpc[n - i - 1] * C(i - 1);
-            }
-        }
-    }
+static void update(KarmaState& state, const double *lpc, int lpcOrder, double sampleRate)
+{
+    const StateVector& m_pred = state.m_up;
+    const StateMatrix& P_pred = state.P_up;
+
+    CepVector y, y_pred;
+    CepMatrix H;
+    calcCepstrumCoefs(lpc, lpcOrder, y);
+    calcCepstrumModel(m_pred, sampleRate, y_pred, H);
 
-    return C;
+    const CepMatrix HP = H * P_pred;
+    CepCovariance S = HP * H.transpose();
+    S += state.R;
+
+    // K = P H' S^-1, with S symmetric positive definite.
+    const Matrix<double, numS, ncep> K = S.llt().solve(HP).transpose();
+
+    state.m_up = m_pred + K * (y - y_pred);
+    state.P_up = P_pred - K * HP;
 }
 
-MatrixXd calcMatrixH(const VectorXd &m, int cepOrder, double Fs)
+static FormantResult stateToResult(const StateVector& m)
 {
-    const int numF = m.size() / 2;
-    auto freq = m.segment(0, numF);
-    auto band = m.segment(numF, numF);
-
-    MatrixXd H(cepOrder, 2 * numF);
+    rpm::vector<Analysis::FormantData> formants(numF);
+    for (int i = 0; i < numF; ++i) {
+        formants[i] = {
+            .frequency = m(i),
+            .bandwidth = m(numF + i),
+        };
+    }
 
-    for (int i = 0; i < cepOrder; ++i) {
-        for (int j = 0; j < numF; ++j) {
-            const double bwTerm = exp((-M_PI * (i + 1) * band(j)) / Fs);
+    return { .formants = formants };
+}
 
-            H(i, j)        = -4.0 * M_PI / Fs * bwTerm * sin((2.0 * M_PI * (i + 1) * freq(j)) / Fs);
-            H(i, numF + j) = -2.0 * M_PI / Fs * bwTerm * cos((2.0 * M_PI * (i + 1) * freq(j)) / Fs);
+// Cepstrum of 1/A(z), A(z) = 1 + lpc[0] z^-1 + ... + lpc[lpcOrder-1] z^-lpcOrder.
+void calcCepstrumCoefs(const double *lpc, int lpcOrder, CepVector& C)
+{
+    for (int n = 1; n <= ncep; ++n) {
+        double c = (n <= lpcOrder) ? -lpc[n - 1] : 0.0;
+        for (int k = std::max(1, n - lpcOrder); k <= n - 1; ++k) {
+            c -= (double) k / (double) n * lpc[n - k - 1] * C(k - 1);
         }
+        C(n - 1) = c;
     }
-
-    return H;
 }
 
-VectorXd calcCepstrumMapping(const VectorXd& m, int cepOrder, double Fs)
+// Cepstrum of the resonator cascade in state m and its Jacobian. Powers of the
+// pole r e^(i theta) replace the exp/sin/cos of every coefficient.
+void calcCepstrumModel(const StateVector& m, double Fs, CepVector& C, CepMatrix& H)
 {
-    const int numF = m.size() / 2;
-    auto freq = m.segment(0, numF);
-    auto band = m.segment(numF, numF);
+    C.setZero();
+
+    for (int j = 0; j < numF; ++j) {
+        const std::complex<double> pole = std::polar(exp(-M_PI * m(numF + j) / Fs), 2.0 * M_PI * m(j) / Fs);
+        std::complex<double> power = pole;
 
-    VectorXd C_int(numF);
-    VectorXd C(cepOrder);
+        for (int i = 0; i < ncep; ++i) {
+            C(i) += 2.0 / (double) (i + 1) * power.real();
 
-    for (int i = 0; i < cepOrder; ++i) {
-        for (int p = 0; p < numF; ++p) {
-            const double bwTerm = (2.0 / (double) (i + 1)) * exp((-M_PI * (i + 1) * band(p)) / Fs);
-            C_int(p) = bwTerm * cos((2.0 * M_PI * (i + 1) * freq(p)) / Fs);
+            H(i, j)        = -4.0 * M_PI / Fs * power.imag();
+            H(i, numF + j) = -2.0 * M_PI / Fs * power.real();
+
+            power *= pole;
         }
-        C(i) = C_int.sum();
     }
-
-    return C;
 }
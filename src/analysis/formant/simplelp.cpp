@@ -1,16 +1,22 @@
 #include "formant.h"
 #include "../util/util.h"
+#include "../util/parallel.h"
 
 using namespace Analysis::Formant;
 using Analysis::FormantResult;
 
 FormantResult SimpleLP::solve(const double *lpc, int lpcOrder, double sampleRate)
+{
+    return solve(lpc, lpcOrder, sampleRate, tracker);
+}
+
+FormantResult SimpleLP::solve(const double *lpc, int lpcOrder, double sampleRate, RootTracker& tracker)
 {
     rpm::vector<double> polynomial(lpcOrder + 1);
     polynomial[0] = 1.0;
     std::copy(lpc, lpc + lpcOrder, std::next(polynomial.begin()));
     
-    rpm::vector<std::complex<double>> roots = findRoots(polynomial);
+    rpm::vector<std::complex<double>> roots = tracker.solve(polynomial);
 
     FormantResult result;
 
@@ -33,3 +39,17 @@ FormantResult SimpleLP::solve(const double *lpc, int lpcOrder, double sampleRate
 
     return result;
 }
+
+void SimpleLP::reset()
+{
+    tracker.reset();
+}
+
+void SimpleLP::solveBatch(const double *lpc, int count, int lpcOrder, double sampleRate, FormantResult *results)
+{
+    parallelFor(count, [&](int begin, int end) {
+        RootTracker tracker;
+        for (int i = begin; i < end; ++i)
+            results[i] = solve(lpc + i * lpcOrder, lpcOrder, sampleRate, tracker);
+    });
+}
@@ -0,0 +1,83 @@
+#include "freqz.h"
+#include <cmath>
+#include <stdexcept>
+
+using namespace Analysis;
+
+FrequencyResponse::FrequencyResponse(int n)
+    : mFFT(n),
+      mGrid(n / 2 + 1)
+{
+    for (int k = 0; k < (int) mGrid.size(); ++k)
+        mGrid[k] = std::polar(1.0, 2.0 * M_PI * k / n);
+}
+
+int FrequencyResponse::getLength() const
+{
+    return mGrid.size();
+}
+
+void FrequencyResponse::sos(const rpm::vector<std::array<double, 6>>& sos, int first, int count, double *h)
+{
+    checkRange(first, count);
+    FrequencyResponse::sos(sos, mGrid.data() + first, count, h);
+}
+
+void FrequencyResponse::lpc(const double *lpc, int lpcOrder, double gain, int first, int count, double *h)
+{
+    checkRange(first, count);
+
+    const int n = mFFT.getInputLength();
+
+    if (lpcOrder + 1 > n) {
+        throw std::runtime_error("FrequencyResponse] LPC order is too high for the transform length");
+    }
+
+    mFFT.input(0) = 1.0;
+    for (int i = 0; i < lpcOrder; ++i)
+        mFFT.input(i + 1) = lpc[i];
+    for (int i = lpcOrder + 1; i < n; ++i)
+        mFFT.input(i) = 0.0;
+
+    mFFT.computeForward();
+
+    for (int i = 0; i < count; ++i)
+        h[i] = gain / std::sqrt(std::norm(mFFT.output(first + i)));
+}
+
+void FrequencyResponse::sos(const rpm::vector<std::array<double, 6>>& sos, const std::complex<double> *z, int count, double *h)
+{
+    std::fill(h, h + count, 1.0);
+
+    for (const auto& sec : sos) {
+        const double a0 = sec[3];
+        const double b0 = sec[0] / a0, b1 = sec[1] / a0, b2 = sec[2] / a0;
+        const double a1 = sec[4] / a0, a2 = sec[5] / a0;
+
+        // z^2 B(z) and z^2 A(z), same magnitude on the unit circle.
+        for (int k = 0; k < count; ++k) {
+            const double zr = z[k].real();
+            const double zi = z[k].imag();
+
+            const double br = b0 * zr + b1, bi = b0 * zi;
+            const double nr = br * zr - bi * zi + b2;
+            const double ni = br * zi + bi * zr;
+
+            const double ar = zr + a1, ai = zi;
+            const double dr = ar * zr - ai * zi + a2;
+            const double di = ar * zi + ai * zr;
+
+            h[k] *= (nr * nr + ni * ni) / (dr * dr + di * di);
+        }
+    }
+
+    for (int k = 0; k < count; ++k)
+        h[k] = std::sqrt(h[k]);
+}
+
+void FrequencyResponse::checkRange(int first, int count) const
+{
+    if (first < 0 || count < 0 || first + count > getLength()) {
+        throw std::runtime_error("FrequencyResponse] Bins out of range");
+    }
+}
@@ -2,6 +2,7 @@
 #define ANALYSIS_FREQZ_H
 
 #include "rpcxx.h"
+#include "../fft/fft.h"
 #include <utility>
 #include <complex>
 #include <array>
@@ -9,6 +10,38 @@
 namespace Analysis
 {
     rpm::vector<double> sosfreqz(const rpm::vector<std::array<double, 6>>& sos, const rpm::vector<std::complex<double>>& wn);
+
+    /*
+     *  Magnitude responses on the uniform grid w_k = 2 pi k / n, k = 0 .. n/2,
+     *  written for bins first .. first + count - 1.
+     *
+     *  LPC envelopes are taken from one zero-padded real FFT of the predictor.
+     *  Second-order sections are evaluated directly on a cached grid: a 3-tap
+     *  polynomial costs less than its transform, and expanding the cascade
+     *  into one polynomial loses all precision when poles cluster near z = 1.
+     */
+    class FrequencyResponse
+    {
+    public:
+        FrequencyResponse(int n);
+
+        int getLength() const;
+
+        // Sections are {b0, b1, b2, a0, a1, a2}.
+        void sos(const rpm::vector<std::array<double, 6>>& sos, int first, int count, double *h);
+
+        // gain / |A|, with A(z) = 1 + lpc[0] z^-1 + ... + lpc[lpcOrder-1] z^-lpcOrder.
+        void lpc(const double *lpc, int lpcOrder, double gain, int first, int count, double *h);
+
+        // Any points on the unit circle, evaluated with Horner's scheme.
+        static void sos(const rpm::vector<std::array<double, 6>>& sos, const std::complex<double> *z, int count, double *h);
+
+    private:
+        void checkRange(int first, int count) const;
+
+        RealFFT mFFT;
+        rpm::vector<std::complex<double>> mGrid;
+    };
 }
 
 #endif // ANALYSIS_FREQZ_H
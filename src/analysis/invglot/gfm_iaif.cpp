@@ -1,146 +1,115 @@
 #include "invglot.h"
 #include "../filter/filter.h"
+#include <algorithm>
 #include <cmath>
-#include <iostream>
 
 using namespace Analysis::Invglot;
 using Analysis::InvglotResult;
 
+static constexpr int ng = 3;
+
 GFM_IAIF::GFM_IAIF(double d)
-    : d(d)
+    : d(d),
+      frameLength(0),
+      frameSampleRate(0.0)
 {
     lpc = std::make_unique<LP::Burg>();
 }
 
-/*
-static void applyWindow(const rpm::vector<double>& w, const rpm::vector<double>& x, rpm::vector<double>& y)
+void GFM_IAIF::prepare(int length, double sampleRate)
 {
-    y.resize(x.size());
-    for (int i = 0; i < x.size(); ++i) {
-        y[i] = x[i] * w[i];
+    if (length == frameLength && sampleRate == frameSampleRate) {
+        return;
     }
-}
-*/
 
-static rpm::vector<double> calculateLPC(const rpm::vector<double>& x, const rpm::vector<double>& w, int len, int order, std::unique_ptr<Analysis::LinpredSolver>& lpc)
-{
-    static rpm::vector<double> lpcIn;
-    static double gain;
+    frameLength = length;
+    frameSampleRate = sampleRate;
 
-    lpcIn.resize(len);
-    for (int i = 0; i < len; ++i) {
-        lpcIn[i] = w[i] * x[x.size() / 2 - len / 2 + i];
+    nv = std::round(sampleRate / 1000);
+    Lpf = nv + 1;
+    lpW = std::min<int>(std::round(0.015 * sampleRate), length);
+
+    window.resize(lpW);
+    for (int i = 0; i < lpW; ++i) {
+        window[i] = 0.5 - 0.5 * cos((2.0 * M_PI * i) / (double) (length - 1));
     }
-    auto a = lpc->solve(lpcIn.data(), len, order, &gain);
-    a.insert(a.begin(), 1.0);
-    return a;
-}
 
-static rpm::vector<double> removePreRamp(const rpm::vector<double>& x, int preflt)
-{
-    return rpm::vector<double>(std::next(x.begin(), preflt), x.end());
-}
+    hpfilt = Analysis::butterworthHighpass(10, 70.0, sampleRate);
+    hpState.resize(2 * hpfilt.size());
 
-inline double G(double x, int L, double alpha)
-{
-    const int N = L - 1;
-    const double k = (x - N / 2.0) / (2 * L * alpha);
-    return expf(-(k * k));
+    s_gv.resize(lpW);
+    x_gv.resize(Lpf + length);
+    lpcIn.resize(lpW);
+    ag.resize(ng + 1);
+    av.resize(nv + 1);
 }
 
-/*
-static void calcGaussian(rpm::vector<double>& win, double alpha)
+void GFM_IAIF::fitLPC(const double *x, int order, double *a)
 {
-    const int L = win.size();
-    
-    double Gmh = G(-0.5, L, alpha);
-    double GmhpLpGmhmL = G(-0.5 + L, L, alpha) - G(-0.5 - L, L, alpha);
-
-    for (int n = 0; n < L; ++n) {
-        win[n] = G(n, L, alpha) - (Gmh * (G(n + L, L, alpha) + G(n - L, L, alpha))) / GmhpLpGmhmL;
-    }
-}
-*/
-
-static rpm::vector<double> conv(const rpm::vector<double>& x, const rpm::vector<double>& y) {
-    int lx = x.size();
-    int ly = y.size();
-    int lw = lx + ly - 1;
-    rpm::vector<double> w(lw, 0.0);
-    for (int k = 0; k < lw; ++k) {
-        int i = k;
-        for (int j = 0; j < ly; ++j) {
-            if (i >= 0 && i < lx) {
-                w[k] += x[i] * y[j];
-            }
-            i--;
-        }
+    for (int i = 0; i < lpW; ++i) {
+        lpcIn[i] = window[i] * x[i];
     }
-    return w;
+
+    double gain;
+    lpc->solveBatch(lpcIn.data(), 1, lpW, lpW, order, a + 1, &gain);
+    a[0] = 1.0;
 }
 
-InvglotResult GFM_IAIF::solve(const double *xData, int length, double sampleRate)
+InvglotResult GFM_IAIF::solve(const double *x, int length, double sampleRate)
 {
-    const int ng = 3;
-    const int nv = std::round(sampleRate / 1000);
-    const int Lpf = nv + 1;
-
-    const int lpW = std::round(0.015 * sampleRate);
+    prepare(length, sampleRate);
 
-    rpm::vector<double> one({1.0});
-    rpm::vector<double> oneMinusD({1.0, -d});
-
-    static rpm::vector<double> window;
-    if (window.size() != lpW) {
-        window.resize(lpW);
-        for (int i = 0; i < lpW; ++i) {
-            window[i] = 0.5 - 0.5 * cos((2.0 * M_PI * i) / (double) (length - 1));
-        }
-    }
+    // Every LPC fit looks at the centre of the frame, only the last filter needs the whole signal.
+    const int offset = length / 2 - lpW / 2;
+    const int start = Lpf + offset;
+    const int end = start + lpW;
 
-    rpm::vector<double> s_gvl(xData, xData + length);
-
-    static rpm::vector<std::array<double, 6>> hpfilt;
-    if (hpfilt.empty()) {
-        hpfilt = Analysis::butterworthHighpass(10, 70.0, sampleRate);
+    // High-passed frame after a ramp up to its first sample.
+    sosfilter(hpfilt, x, length, x_gv.data() + Lpf, hpState.data());
+    for (int i = 0; i < Lpf; ++i) {
+        x_gv[i] = 2.0 * ((double) i / (double) (Lpf - 1) - 0.5) * x_gv[Lpf];
     }
-    s_gvl = sosfilter(hpfilt, s_gvl);
 
-    rpm::vector<double> x_gvl(Lpf + length);
+    // Integrates with and without the ramp in the same pass, the latter only over the window.
+    double xv = 0.0;
     for (int i = 0; i < Lpf; ++i) {
-        x_gvl[i] = 2.0 * ((double) i / (double) (Lpf - 1) - 0.5) * s_gvl[0];
+        xv = x_gv[i] + d * xv;
+        x_gv[i] = xv;
     }
+    double sv = 0.0;
     for (int i = 0; i < length; ++i) {
-        x_gvl[Lpf + i] = s_gvl[i];
+        const double h = x_gv[Lpf + i];
+        sv = h + d * sv;
+        xv = h + d * xv;
+        x_gv[Lpf + i] = xv;
+        if (i >= offset && i < offset + lpW)
+            s_gv[i - offset] = sv;
     }
-   
-    auto s_gv = filter(one, oneMinusD, s_gvl);
-    auto x_gv = filter(one, oneMinusD, x_gvl);
-    
-    auto ag1 = calculateLPC(s_gv, window, lpW, 1, lpc);
-
-    for (int i = 1; i < ng; ++i) {
-        auto x_v1x = filter(ag1, x_gv);
-        auto s_v1x = removePreRamp(x_v1x, Lpf);
-        
-        auto ag1x = calculateLPC(s_v1x, window, lpW, 1, lpc); 
-
-        ag1 = conv(ag1, ag1x);
+
+    // Glottal contribution as ng first order fits, multiplied together in place.
+    fitLPC(s_gv.data(), 1, ag.data());
+    for (int k = 1; k < ng; ++k) {
+        double ag1x[2];
+        firFilter(ag.data(), k + 1, x_gv.data(), start, end, lpcIn.data());
+        fitLPC(lpcIn.data(), 1, ag1x);
+
+        ag[k + 1] = ag[k] * ag1x[1];
+        for (int j = k; j >= 1; --j) {
+            ag[j] = ag[j] + ag[j - 1] * ag1x[1];
+        }
     }
 
-    auto x_v1 = filter(ag1, x_gv);
-    auto s_v1 = removePreRamp(x_v1, Lpf);
-    auto av1 = calculateLPC(s_v1, window, lpW, nv, lpc);
+    firFilter(ag.data(), ng + 1, x_gv.data(), start, end, lpcIn.data());
+    fitLPC(lpcIn.data(), nv, av.data());
 
-    auto x_g1 = filter(av1, x_gv);
-    auto s_g1 = removePreRamp(x_g1, Lpf);
-    auto ag = calculateLPC(s_g1, window, lpW, ng, lpc);
+    firFilter(av.data(), nv + 1, x_gv.data(), start, end, lpcIn.data());
+    fitLPC(lpcIn.data(), ng, ag.data());
 
-    auto x_v = filter(ag, x_gv);
-    auto s_v = removePreRamp(x_v, Lpf);
-    auto av = calculateLPC(s_v, window, lpW, nv, lpc);
+    firFilter(ag.data(), ng + 1, x_gv.data(), start, end, lpcIn.data());
+    fitLPC(lpcIn.data(), nv, av.data());
 
-    auto g = removePreRamp(filter(av, x_gv), Lpf);
+    rpm::vector<double> g(length);
+    firFilter(av.data(), nv + 1, x_gv.data(), Lpf, Lpf + length, g.data());
 
     double gMax = 1e-10;
     for (int i = 0; i < length; ++i) {
@@ -1,121 +1,114 @@
 #include "invglot.h"
 #include "../filter/filter.h"
+#include <algorithm>
 #include <cmath>
-#include <iostream>
 
 using namespace Analysis::Invglot;
 using Analysis::InvglotResult;
 
 IAIF::IAIF(double d)
-    : d(d)
+    : d(d),
+      frameLength(0),
+      frameSampleRate(0.0)
 {
     lpc = std::make_unique<LP::Burg>();
 }
 
-static void applyWindow(const rpm::vector<double>& w, const rpm::vector<double>& x, rpm::vector<double>& y)
+void IAIF::prepare(int length, double sampleRate)
 {
-    y.resize(x.size());
-    for (int i = 0; i < x.size(); ++i) {
-        y[i] = x[i] * w[i];
+    if (length == frameLength && sampleRate == frameSampleRate) {
+        return;
     }
-}
 
-static rpm::vector<double> calculateLPC(const rpm::vector<double>& x, const rpm::vector<double>& w, int len, int order, std::unique_ptr<Analysis::LinpredSolver>& lpc)
-{
-    static rpm::vector<double> lpcIn;
-    static double gain;
+    frameLength = length;
+    frameSampleRate = sampleRate;
+
+    p_vt = 2 * std::round(sampleRate / 2000) + 4;
+    lpW = std::min<int>(std::round(0.015 * sampleRate), length);
+    preflt = p_vt + 1;
 
-    lpcIn.resize(len);
-    for (int i = 0; i < len; ++i) {
-        lpcIn[i] = w[i] * x[x.size() / 2 - len / 2 + i];
+    window.resize(lpW);
+    for (int i = 0; i < lpW; ++i) {
+        window[i] = 0.5 - 0.5 * cos((2.0 * M_PI * i) / (double) (length - 1));
     }
-    auto a = lpc->solve(lpcIn.data(), len, order, &gain);
-    a.insert(a.begin(), 1.0);
-    return a;
-}
 
-static rpm::vector<double> removePreRamp(const rpm::vector<double>& x, int preflt)
-{
-    return rpm::vector<double>(std::next(x.begin(), preflt), x.end());
+    hpfilt = Analysis::butterworthHighpass(8, 70.0, sampleRate);
+    hpState.resize(2 * hpfilt.size());
+
+    xp.resize(preflt + length);
+    work.resize(preflt + length);
+    lpcIn.resize(lpW);
+    a.resize(p_vt + 1);
 }
 
-inline double G(double x, int L, double alpha)
+void IAIF::fitLPC(const double *x, int order, double *a)
 {
-    const int N = L - 1;
-    const double k = (x - N / 2.0) / (2 * L * alpha);
-    return expf(-(k * k));
+    for (int i = 0; i < lpW; ++i) {
+        lpcIn[i] = window[i] * x[i];
+    }
+
+    double gain;
+    lpc->solveBatch(lpcIn.data(), 1, lpW, lpW, order, a + 1, &gain);
+    a[0] = 1.0;
 }
 
-static void calcGaussian(rpm::vector<double>& win, double alpha)
+// FIR followed by the leaky integrator 1 / (1 - d z^-1), for the first end samples.
+static void firIntegrate(const double *b, int nb, double d, const double *x, int end, double *y)
 {
-    const int L = win.size();
-    
-    double Gmh = G(-0.5, L, alpha);
-    double GmhpLpGmhmL = G(-0.5 + L, L, alpha) - G(-0.5 - L, L, alpha);
-
-    for (int n = 0; n < L; ++n) {
-        win[n] = G(n, L, alpha) - (Gmh * (G(n + L, L, alpha) + G(n - L, L, alpha))) / GmhpLpGmhmL;
+    double acc = 0.0;
+    for (int i = 0; i < end; ++i) {
+        const int taps = std::min(nb, i + 1);
+        double sum = 0.0;
+        for (int j = 0; j < taps; ++j) {
+            sum += b[j] * x[i - j];
+        }
+        acc = sum + d * acc;
+        y[i] = acc;
     }
 }
 
-InvglotResult IAIF::solve(const double *xData, int length, double sampleRate)
+InvglotResult IAIF::solve(const double *x, int length, double sampleRate)
 {
     const int p_gl = 2;
-    const int p_vt = 2 * std::round(sampleRate / 2000) + 4;
 
-    const int lpW = std::round(0.015 * sampleRate);
+    prepare(length, sampleRate);
 
-    rpm::vector<double> one({1.0});
-    rpm::vector<double> oneMinusD({1.0, -d});
+    const int n = preflt + length;
 
-    static rpm::vector<double> window;
-    if (window.size() != lpW) {
-        window.resize(lpW);
-        for (int i = 0; i < lpW; ++i) {
-            window[i] = 0.5 - 0.5 * cos((2.0 * M_PI * i) / (double) (length - 1));
-        }
-    }
-
-    rpm::vector<double> x(xData, xData + length);
-   
-    static rpm::vector<std::array<double, 6>> hpfilt;
-    if (hpfilt.empty()) {
-        hpfilt = Analysis::butterworthHighpass(8, 70.0, sampleRate);
-    }
-
-    int preflt = p_vt + 1;
-
-    rpm::vector<double> xWithPreRamp(preflt + length);
+    // Ramp up to the first sample so that the filters start smoothly.
     for (int i = 0; i < preflt; ++i) {
-        xWithPreRamp[i] = 2.0 * ((double) i / (double) (preflt - 1) - 0.5) * x[0];
-    }
-    for (int i = 0; i < length; ++i) {
-        xWithPreRamp[preflt + i] = x[i];
+        xp[i] = 2.0 * ((double) i / (double) (preflt - 1) - 0.5) * x[0];
     }
+    std::copy(x, x + length, xp.begin() + preflt);
+
+    sosfilter(hpfilt, xp.data(), n, xp.data(), hpState.data());
 
-    xWithPreRamp = sosfilter(hpfilt, xWithPreRamp);
-    x = removePreRamp(xWithPreRamp, preflt);
+    // Every LPC fit looks at the centre of the frame, only the last filter needs the whole signal.
+    const int start = preflt + length / 2 - lpW / 2;
+    const int end = start + lpW;
 
-    auto Hg1 = calculateLPC(x, window, lpW, 1, lpc);
-    auto y1 = removePreRamp(filter(Hg1, one, xWithPreRamp), preflt);
+    fitLPC(xp.data() + start, 1, a.data());
+    firFilter(a.data(), 2, xp.data(), start, end, lpcIn.data());
 
-    auto Hvt1 = calculateLPC(y1, window, lpW, p_vt, lpc);
-    auto g1 = removePreRamp(filter(one, oneMinusD, filter(Hvt1, one, xWithPreRamp)), preflt);
+    fitLPC(lpcIn.data(), p_vt, a.data());
+    firIntegrate(a.data(), p_vt + 1, d, xp.data(), end, work.data());
 
-    auto Hg2 = calculateLPC(g1, window, lpW, p_gl, lpc);
-    auto y = removePreRamp(filter(one, oneMinusD, filter(Hg2, one, xWithPreRamp)), preflt);
+    fitLPC(work.data() + start, p_gl, a.data());
+    firIntegrate(a.data(), p_gl + 1, d, xp.data(), end, work.data());
 
-    auto Hvt2 = calculateLPC(y, window, lpW, p_vt, lpc);
-    auto g = removePreRamp(filter(one, oneMinusD, filter(Hvt2, one, xWithPreRamp)), preflt);
+    fitLPC(work.data() + start, p_vt, a.data());
+    firIntegrate(a.data(), p_vt + 1, d, xp.data(), n, work.data());
 
     double gMax = 1e-10;
-    for (int i = 0; i < length; ++i) {
-        double absG = fabs(g[i]);
+    for (int i = preflt; i < n; ++i) {
+        double absG = fabs(work[i]);
         if (absG > gMax)
             gMax = absG;
     }
+
+    rpm::vector<double> g(length);
     for (int i = 0; i < length; ++i) {
-        g[i] /= gMax;
+        g[i] = work[preflt + i] / gMax;
     }
 
     return {
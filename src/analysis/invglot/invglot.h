@@ -4,6 +4,7 @@
 #include "rpcxx.h"
 #include "../linpred/linpred.h"
 #include "../fft/fft.h"
+#include <array>
 #include <memory>
 #include <Eigen/Dense>
 
@@ -18,16 +19,43 @@ namespace Analysis {
     public:
         virtual ~InvglotSolver() {}
         virtual InvglotResult solve(const double *x, int length, double sampleRate) = 0;
+
+        // Frame i starts at frames + i * stride.
+        virtual void solveBatch(const double *frames, int count, int length, int stride, double sampleRate, InvglotResult *results)
+        {
+            for (int i = 0; i < count; ++i)
+                results[i] = solve(frames + i * stride, length, sampleRate);
+        }
     };
 
     namespace Invglot {
+        /*
+         *  Both IAIF variants keep their filter designs and buffers per instance,
+         *  rebuilt only when the frame length or the sample rate changes. The
+         *  intermediate signals are only needed over the LPC analysis window,
+         *  so the filters before the last one only run over that span.
+         */
         class IAIF : public InvglotSolver {
         public:
             IAIF(double d);
             InvglotResult solve(const double *x, int length, double sampleRate) override;
         private:
+            void prepare(int length, double sampleRate);
+            // Windowed LPC of the lpW samples at x, a receives 1 then the coefficients.
+            void fitLPC(const double *x, int order, double *a);
+
             std::unique_ptr<LinpredSolver> lpc;
             double d;
+
+            int frameLength;
+            double frameSampleRate;
+            int p_vt;
+            int lpW;
+            int preflt;
+            rpm::vector<double> window;
+            rpm::vector<std::array<double, 6>> hpfilt;
+            rpm::vector<double> hpState;
+            rpm::vector<double> xp, work, lpcIn, a;
         };
 
         class GFM_IAIF : public InvglotSolver {
@@ -35,8 +63,22 @@ namespace Analysis {
             GFM_IAIF(double d);
             InvglotResult solve(const double *x, int length, double sampleRate) override;
         private:
+            void prepare(int length, double sampleRate);
+            // Windowed LPC of the lpW samples at x, a receives 1 then the coefficients.
+            void fitLPC(const double *x, int order, double *a);
+
             std::unique_ptr<LinpredSolver> lpc;
             double d;
+
+            int frameLength;
+            double frameSampleRate;
+            int nv;
+            int Lpf;
+            int lpW;
+            rpm::vector<double> window;
+            rpm::vector<std::array<double, 6>> hpfilt;
+            rpm::vector<double> hpState;
+            rpm::vector<double> s_gv, x_gv, lpcIn, ag, av;
         };
 
         class AMGIF : public InvglotSolver {
@@ -1,29 +1,24 @@
 #include "linpred.h"
+#include "../fft/fft.h"
+#include "../util/parallel.h"
 
 using namespace Analysis::LP;
 
-rpm::vector<double> Autocorr::solve(const double *data, int length, int lpcOrder, double *pGain)
+rpm::vector<double> Analysis::LP::levinson(const double *r0, int lpcOrder, double *pGain)
 {
-    const int n = length;
     const int m = lpcOrder;
 
-    static rpm::vector<double> r, a, rc;
-    r.resize(1 + (m + 1));
-    a.resize(1 + (m + 1));
-    rc.resize(1 + (m));
+    // One-based indexing, r[k + 1] holds lag k.
+    rpm::vector<double> r(1 + (m + 1));
+    rpm::vector<double> a(1 + (m + 1), 0.0);
+    rpm::vector<double> rc(1 + (m), 0.0);
     double gain;
     int i, j;
-    std::fill(r.begin(), r.end(), 0.0);
-    std::fill(a.begin(), a.end(), 0.0);
-    std::fill(rc.begin(), rc.end(), 0.0);
 
-    j = m + 1;
-    while (j--) {
-        double d = 0.0;
-        for (i = j; i < n; ++i)
-            d += data[i] * data[i - j];
-        r[j + 1] = d;
-    }
+    r[0] = 0.0;
+    for (j = 0; j <= m; ++j)
+        r[j + 1] = r0[j];
+
     if (r[1] == 0.0) {
         i = 1;
         gain = 1e-10;
@@ -62,3 +57,130 @@ end:
     return lpc;
 }
 
+void Analysis::LP::levinsonOrders(const double *r, int maxOrder, double *lpc, double *errors)
+{
+    const int m = maxOrder;
+
+    rpm::vector<double> a(m + 1, 0.0);
+    rpm::vector<double> prev(m + 1);
+    a[0] = 1.0;
+
+    double error = r[0];
+    errors[0] = error;
+
+    int p;
+    for (p = 1; p <= m && error > 0.0; ++p) {
+        double s = 0.0;
+        for (int j = 0; j < p; ++j)
+            s += a[j] * r[p - j];
+        const double k = -s / error;
+
+        prev = a;
+        for (int j = 1; j < p; ++j)
+            a[j] = prev[j] + k * prev[p - j];
+        a[p] = k;
+
+        error *= 1.0 - k * k;
+
+        double *row = lpc + (p - 1) * m;
+        std::fill(std::copy(std::next(a.begin()), a.begin() + p + 1, row), row + m, 0.0);
+        errors[p] = error;
+    }
+
+    // Orders past a breakdown keep the last valid one.
+    for (; p <= m; ++p) {
+        double *row = lpc + (p - 1) * m;
+        if (p > 1)
+            std::copy(row - m, row, row);
+        else
+            std::fill(row, row + m, 0.0);
+        errors[p] = errors[p - 1];
+    }
+}
+
+rpm::vector<double> Autocorr::solve(const double *data, int length, int lpcOrder, double *pGain)
+{
+    const int n = length;
+    const int m = lpcOrder;
+
+    r.resize(m + 1);
+
+    for (int j = 0; j <= m; ++j) {
+        double d = 0.0;
+        for (int i = j; i < n; ++i)
+            d += data[i] * data[i - j];
+        r[j] = d;
+    }
+
+    return levinson(r.data(), m, pGain);
+}
+
+void Autocorr::solveOrders(const double *data, int length, int maxOrder, double *lpc, double *errors)
+{
+    const int n = length;
+    const int m = maxOrder;
+
+    r.resize(m + 1);
+
+    for (int j = 0; j <= m; ++j) {
+        double d = 0.0;
+        for (int i = j; i < n; ++i)
+            d += data[i] * data[i - j];
+        r[j] = d;
+    }
+
+    levinsonOrders(r.data(), m, lpc, errors);
+}
+
+void Autocorr::solveBatch(const double *frames, int count, int length, int stride, int lpcOrder, double *lpc, double *gains)
+{
+    constexpr int kBlock = 32;
+
+    const int n = length;
+    const int m = lpcOrder;
+
+    // No circular wrap-around on lags 0..m.
+    const int nfft = nextFastLength(n + m);
+
+    parallelFor(count, [&](int begin, int end) {
+        auto plan = batchFFTs.acquire(nfft, std::min(kBlock, end - begin));
+        BatchRealFFT& fft = *plan;
+        const int outLength = fft.getOutputLength();
+
+        rpm::vector<double> r(m + 1);
+
+        for (int first = begin; first < end; first += fft.getCount()) {
+            const int block = std::min(fft.getCount(), end - first);
+
+            for (int f = 0; f < block; ++f) {
+                const double *x = frames + (first + f) * stride;
+                for (int i = 0; i < n; ++i)
+                    fft.input(f, i) = x[i];
+                for (int i = n; i < nfft; ++i)
+                    fft.input(f, i) = 0.0;
+            }
+            for (int f = block; f < fft.getCount(); ++f) {
+                for (int i = 0; i < nfft; ++i)
+                    fft.input(f, i) = 0.0;
+            }
+
+            fft.computeForward();
+            for (int f = 0; f < fft.getCount(); ++f) {
+                for (int k = 0; k < outLength; ++k)
+                    fft.output(f, k) = std::norm(fft.output(f, k));
+            }
+            fft.computeBackward();
+
+            for (int f = 0; f < block; ++f) {
+                for (int j = 0; j <= m; ++j)
+                    r[j] = fft.input(f, j) / nfft;
+
+                double *row = lpc + (first + f) * m;
+                const auto a = levinson(r.data(), m, &gains[first + f]);
+                std::fill(std::copy(a.begin(), a.end(), row), row + m, 0.0);
+            }
+        }
+
+        batchFFTs.release(std::move(plan));
+    });
+}
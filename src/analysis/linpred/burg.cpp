@@ -1,84 +1,160 @@
 #include "linpred.h"
+#include <Eigen/Dense>
 #include <algorithm>
 
 using namespace Analysis::LP;
 
-static double vecBurgBuffered(
-        double *lpc,
-        const int m,
-        const double *data,
-        const int n)
+/*
+ *  Fast Burg (K. Vos, "A Fast Implementation of Burg's Method", 2013).
+ *
+ *  The forward and backward error energies at order i are quadratic forms
+ *  of the predictor in the signal's autocorrelation, minus the few error
+ *  samples that fall outside the Burg summation range at either end of the
+ *  frame. Those edge errors follow the usual lattice recursion, the end of
+ *  the frame being handled as the start of the time-reversed frame, so
+ *  after one pass over the data every order costs O(p).
+ */
+rpm::vector<double> Burg::solve(const double *x, int length, int lpcOrder, double *pGain)
 {
-    static rpm::vector<double> b1, b2, aa;
-    b1.resize(1 + (n));
-    b2.resize(1 + (n));
-    aa.resize(1 + (m));
-    int i, j;
-    std::fill(b1.begin(), b1.end(), 0.0);
-    std::fill(b2.begin(), b2.end(), 0.0);
-    std::fill(aa.begin(), aa.end(), 0.0);
-
-    // Simulating index-1-based array.
-    double *a = &lpc[-1];
-    const double *x = &data[-1];
-    
-    double p = 0.0;
-    for (j = 1; j <= n; ++j)
-        p += x[j] * x[j];
-
-    double xms = p / n;
-    if (xms <= 0.0) {
-        return xms;
+    const double gain = recurse(x, length, lpcOrder, nullptr, nullptr);
+
+    if (pGain != nullptr)
+        *pGain = gain > 0.0 ? gain : 1e-10;
+
+    if (gain <= 0.0)
+        return {};
+
+    return rpm::vector<double>(std::next(a.begin()), a.end());
+}
+
+void Burg::solveBatch(const double *frames, int count, int length, int stride, int lpcOrder, double *lpc, double *gains)
+{
+    for (int i = 0; i < count; ++i) {
+        const double gain = recurse(frames + i * stride, length, lpcOrder, nullptr, nullptr);
+        double *row = lpc + i * lpcOrder;
+
+        if (gain > 0.0) {
+            std::copy(std::next(a.begin()), a.end(), row);
+            gains[i] = gain;
+        }
+        else {
+            std::fill(row, row + lpcOrder, 0.0);
+            gains[i] = 1e-10;
+        }
     }
+}
+
+void Burg::solveOrders(const double *x, int length, int maxOrder, double *lpc, double *errors)
+{
+    std::fill(lpc, lpc + maxOrder * maxOrder, 0.0);
+    std::fill(errors, errors + maxOrder + 1, 0.0);
+
+    recurse(x, length, maxOrder, lpc, errors);
+}
+
+double Burg::recurse(const double *x, int length, int lpcOrder, double *lpc, double *errors)
+{
+    const int n = length;
+    const int m = lpcOrder;
+
+    if (n <= m)
+        return 0.0;
+
+    Eigen::Map<const Eigen::VectorXd> xv(x, n);
 
-    b1[1] = x[1];
-    b2[n - 1] = x[n];
-    for (j = 2; j <= n - 1; ++j)
-        b1[j] = b2[j - 1] = x[j];
+    c.resize(m + 1);
+    for (int j = 0; j <= m; ++j)
+        c[j] = xv.head(n - j).dot(xv.tail(n - j));
 
-    for (i = 1; i <= m; ++i) {
-        double num = 0.0, denum = 0.0;
-        for (j = 1; j <= n - i; ++j) {
-            num += b1[j] * b2[j];
-            denum += b1[j] * b1[j] + b2[j] * b2[j];
+    if (c[0] <= 0.0)
+        return 0.0;
+
+    // Edge errors at the start of the frame (f, b) and of the reversed frame (fr, br).
+    f.resize(m + 1);
+    b.resize(m + 1);
+    fr.resize(m + 1);
+    br.resize(m + 1);
+    for (int j = 0; j <= m; ++j) {
+        f[j] = b[j] = x[j];
+        fr[j] = br[j] = x[n - 1 - j];
+    }
+
+    // a holds the order-i predictor padded with one zero, g = Toeplitz(c) * a.
+    a.assign(m + 1, 0.0);
+    g.assign(m + 1, 0.0);
+    a[0] = 1.0;
+    g[0] = c[0];
+    if (m > 0)
+        g[1] = c[1];
+
+    double gain = c[0];
+    if (errors != nullptr)
+        errors[0] = gain;
+
+    for (int i = 0; i < m; ++i) {
+        double energy = 0.0, cross = 0.0;
+        for (int j = 0; j <= i + 1; ++j) {
+            energy += a[j] * g[j];
+            cross += a[i + 1 - j] * g[j];
         }
 
-        if (denum <= 0.0)
+        double excluded = f[0] * f[0] + fr[0] * fr[0];
+        double excludedCross = 0.0;
+        for (int j = 1; j <= i; ++j) {
+            excluded += f[j] * f[j] + b[j - 1] * b[j - 1] + fr[j] * fr[j] + br[j - 1] * br[j - 1];
+            excludedCross += f[j] * b[j - 1] + br[j - 1] * fr[j];
+        }
+
+        const double denum = 2.0 * energy - excluded;
+        if (denum <= 0.0) {
+            // Orders that could not be fitted keep the last valid one.
+            for (int p = i + 1; lpc != nullptr && p <= m; ++p) {
+                if (p > 1)
+                    std::copy(lpc + (p - 2) * m, lpc + (p - 1) * m, lpc + (p - 1) * m);
+                errors[p] = errors[p - 1];
+            }
             return 0.0;
+        }
 
-        a[i] = 2.0 * num / denum;
+        const double k = -2.0 * (cross - excludedCross) / denum;
 
-        xms *= 1.0 - a[i] * a[i];
+        gain *= 1.0 - k * k;
 
-        for (j = 1; j <= i - 1; ++j)
-            a[j] = aa[j] - a[i] * aa[i - j];
+        // a <- a + k J a, g <- g + k J g over the first i + 2 entries.
+        for (int j = 0; j <= (i + 1) / 2; ++j) {
+            const int l = i + 1 - j;
+            const double aj = a[j], al = a[l];
+            const double gj = g[j], gl = g[l];
+            a[j] = aj + k * al;
+            g[j] = gj + k * gl;
+            if (l != j) {
+                a[l] = al + k * aj;
+                g[l] = gl + k * gj;
+            }
+        }
 
-        if (i < m) {
-            for (j = 1; j <= i; ++j)
-                aa[j] = a[j];
-            for (j = 1; j <= n - i - 1; ++j) {
-                b1[j] -= aa[i] * b2[j];
-                b2[j] = b2[j + 1] - aa[i] * b1[j + 1];
+        if (lpc != nullptr) {
+            std::copy(std::next(a.begin()), a.begin() + i + 2, lpc + i * m);
+            errors[i + 1] = gain;
+        }
+
+        if (i + 1 < m) {
+            double s = 0.0;
+            for (int j = 0; j <= i + 1; ++j)
+                s += c[i + 2 - j] * a[j];
+            g[i + 2] = s;
+
+            for (int j = m; j >= 0; --j) {
+                const double bPrev = j > 0 ? b[j - 1] : 0.0;
+                const double brPrev = j > 0 ? br[j - 1] : 0.0;
+                const double fj = f[j], frj = fr[j];
+                f[j] = fj + k * bPrev;
+                b[j] = bPrev + k * fj;
+                fr[j] = frj + k * brPrev;
+                br[j] = brPrev + k * frj;
             }
         }
     }
-   
-    return xms; 
-}
 
-rpm::vector<double> Burg::solve(const double *x, int length, int lpcOrder, double *pGain)
-{
-    const int n = length;
-    const int m = lpcOrder;
-    rpm::vector<double> lpc(m);
-    double gain = vecBurgBuffered(lpc.data(), m, x, n);
-    if (gain <= 0.0) {
-        lpc.resize(0);
-        gain = 1e-10;
-    }
-    gain *= n;
-    std::transform(lpc.begin(), lpc.end(), lpc.begin(), std::negate<>());
-    if (pGain != nullptr)
-        *pGain = gain;
-    return lpc;
+    return gain;
 }
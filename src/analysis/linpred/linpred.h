@@ -2,6 +2,10 @@
 #define ANALYSIS_LINPRED_H
 
 #include "rpcxx.h"
+#include <algorithm>
+#include <memory>
+
+#include "../fft/fft.h"
 
 namespace Analysis {
     
@@ -9,28 +13,97 @@ namespace Analysis {
     public:
         virtual ~LinpredSolver() {}
         virtual rpm::vector<double> solve(const double *x, int length, int lpcOrder, double *gain) = 0;
+
+        // Frame i starts at frames + i * stride. Row i of lpc (lpcOrder values) receives its
+        // coefficients, zero-padded if the recursion stopped early, and gains[i] its gain.
+        virtual void solveBatch(const double *frames, int count, int length, int stride, int lpcOrder, double *lpc, double *gains)
+        {
+            for (int i = 0; i < count; ++i) {
+                const auto a = solve(frames + i * stride, length, lpcOrder, &gains[i]);
+                std::fill(std::copy(a.begin(), a.end(), lpc + i * lpcOrder), lpc + (i + 1) * lpcOrder, 0.0);
+            }
+        }
+
+        // Fits every order from 1 to maxOrder. Row p - 1 of lpc (maxOrder values) receives the
+        // order-p coefficients, zero-padded, and errors[p] its prediction error energy, errors[0]
+        // being the frame energy. Recursive solvers fill all rows in a single pass.
+        virtual void solveOrders(const double *x, int length, int maxOrder, double *lpc, double *errors)
+        {
+            errors[0] = 0.0;
+            for (int i = 0; i < length; ++i)
+                errors[0] += x[i] * x[i];
+            for (int p = 1; p <= maxOrder; ++p) {
+                const auto a = solve(x, length, p, &errors[p]);
+                double *row = lpc + (p - 1) * maxOrder;
+                std::fill(std::copy(a.begin(), a.end(), row), row + maxOrder, 0.0);
+            }
+        }
     };
 
     namespace LP {
+        // Levinson-Durbin recursion on the autocorrelation lags r[0..lpcOrder].
+        rpm::vector<double> levinson(const double *r, int lpcOrder, double *gain);
+
+        // Levinson-Durbin recursion keeping every intermediate order, laid out as in LinpredSolver::solveOrders.
+        void levinsonOrders(const double *r, int maxOrder, double *lpc, double *errors);
+
+        enum class OrderCriterion {
+            AIC,
+            MDL,
+        };
+
+        // Order in [minOrder, maxOrder] minimising length * log(errors[p] / length) plus the
+        // criterion's penalty, 2p for AIC and p log(length) for MDL.
+        int selectOrder(const double *errors, int minOrder, int maxOrder, int length, OrderCriterion criterion);
+
         class Autocorr : public LinpredSolver {
         public:
             rpm::vector<double> solve(const double *x, int length, int lpcOrder, double *gain) override;
+            // Autocorrelations through batched FFTs, frames spread over all cores.
+            void solveBatch(const double *frames, int count, int length, int stride, int lpcOrder, double *lpc, double *gains) override;
+            void solveOrders(const double *x, int length, int maxOrder, double *lpc, double *errors) override;
         private:
-            rpm::vector<double> r, a, rc;
+            rpm::vector<double> r;
+            BatchRealFFTPool batchFFTs;
         };
 
         class Covar : public LinpredSolver {
         public:
             rpm::vector<double> solve(const double *x, int length, int lpcOrder, double *gain) override;
         private:
-            rpm::vector<double> r, a, rc;
+            rpm::vector<double> b, grc, beta, a, cc;
         };
 
         class Burg : public LinpredSolver {
         public:
             rpm::vector<double> solve(const double *x, int length, int lpcOrder, double *gain) override;
+            // Writes straight into lpc, nothing is allocated once the work buffers have grown.
+            void solveBatch(const double *frames, int count, int length, int stride, int lpcOrder, double *lpc, double *gains) override;
+            void solveOrders(const double *x, int length, int maxOrder, double *lpc, double *errors) override;
+        private:
+            // Returns the final error energy, or zero if the recursion broke down.
+            double recurse(const double *x, int length, int lpcOrder, double *lpc, double *errors);
+
+            rpm::vector<double> c, a, g;
+            rpm::vector<double> f, b, fr, br;
+        };
+
+        /*
+         *  Picks the order of each frame with an information criterion. The wrapped
+         *  solver fits every order up to the one requested in a single sweep, and
+         *  the coefficients of the best scoring order are returned. Orders below
+         *  half of the requested one are never picked, so that formant solvers
+         *  always get enough pole pairs to work with.
+         */
+        class OrderSelection : public LinpredSolver {
+        public:
+            OrderSelection(LinpredSolver *solver, OrderCriterion criterion);
+            rpm::vector<double> solve(const double *x, int length, int lpcOrder, double *gain) override;
+            void solveOrders(const double *x, int length, int maxOrder, double *lpc, double *errors) override;
         private:
-            rpm::vector<double> b1, b2, aa;
+            std::unique_ptr<LinpredSolver> solver;
+            OrderCriterion criterion;
+            rpm::vector<double> lpcs, errors;
         };
     }
 
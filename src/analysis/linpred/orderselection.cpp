@@ -0,0 +1,56 @@
+#include "linpred.h"
+#include <cmath>
+#include <limits>
+
+using namespace Analysis::LP;
+
+int Analysis::LP::selectOrder(const double *errors, int minOrder, int maxOrder, int length, OrderCriterion criterion)
+{
+    const double n = length;
+    const double penalty = (criterion == OrderCriterion::AIC) ? 2.0 : std::log(n);
+
+    int best = maxOrder;
+    double bestScore = std::numeric_limits<double>::infinity();
+
+    for (int p = std::max(minOrder, 0); p <= maxOrder; ++p) {
+        const double variance = std::max(errors[p] / n, std::numeric_limits<double>::min());
+        const double score = n * std::log(variance) + penalty * p;
+        if (score < bestScore) {
+            bestScore = score;
+            best = p;
+        }
+    }
+
+    return best;
+}
+
+OrderSelection::OrderSelection(LinpredSolver *solver, OrderCriterion criterion)
+    : solver(solver),
+      criterion(criterion)
+{
+}
+
+rpm::vector<double> OrderSelection::solve(const double *x, int length, int lpcOrder, double *pGain)
+{
+    const int m = lpcOrder;
+
+    if (m <= 0)
+        return solver->solve(x, length, m, pGain);
+
+    lpcs.resize(m * m);
+    errors.resize(m + 1);
+    solver->solveOrders(x, length, m, lpcs.data(), errors.data());
+
+    const int p = selectOrder(errors.data(), std::max(1, (m + 1) / 2), m, length, criterion);
+
+    if (pGain != nullptr)
+        *pGain = errors[p] > 0.0 ? errors[p] : 1e-10;
+
+    const double *row = &lpcs[(p - 1) * m];
+    return rpm::vector<double>(row, row + p);
+}
+
+void OrderSelection::solveOrders(const double *x, int length, int maxOrder, double *lpc, double *errors)
+{
+    solver->solveOrders(x, length, maxOrder, lpc, errors);
+}
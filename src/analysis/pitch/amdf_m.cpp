@@ -6,6 +6,10 @@
 using Analysis::PitchResult;
 using namespace Analysis::Pitch;
 
+// Minimum one-bit and full-precision correlation for a frame to be voiced.
+static constexpr double coarseThreshold = 0.3;
+static constexpr double voicingThreshold = 0.5;
+
 AMDF_M::AMDF_M(double minPitch, double maxPitch, double alpha)
     : mMinPitch(minPitch),
       mMaxPitch(maxPitch),
@@ -13,98 +17,133 @@ AMDF_M::AMDF_M(double minPitch, double maxPitch, double alpha)
 {
 }
 
-PitchResult AMDF_M::solve(const double *data, int length, int sampleRate)
+// Number of sign disagreements between the first `words` words and the same
+// bits delayed by `lag`. The last word is masked to the window length.
+#if defined(__x86_64__) && defined(__linux__)
+__attribute__((target_clones("popcnt", "default")))
+#endif
+static int oneBitAMDF(const uint64_t *bits, int words, uint64_t lastMask, int lag)
 {
-    const int maxShift = length;
-
-    const int maxPeriod = std::min<int>(ceil(sampleRate / mMinPitch), maxShift - 1);
-    const int minPeriod = std::max<int>(floor(sampleRate / mMaxPitch), 2);
-    
-    // Calculate the AMDF.
-    mAMDF.resize(maxShift);
-    
-    double Vmax = 0.0;
-    double Vmin = std::numeric_limits<double>::max();
-
-    for (int i = 0; i < maxShift; ++i) {
-        double sum = 0.0;
-
-        for (int j = 0; j < maxShift - i; ++j) {
-            sum += fabs(data[j] - data[i + j]);
-        }
+    const int q = lag >> 6;
+    const int r = lag & 63;
 
-        mAMDF[i] = sum / (maxShift - i);
+    int count = 0;
 
-        if (mAMDF[i] > Vmax) {
-            Vmax = mAMDF[i];
+    if (r == 0) {
+        for (int k = 0; k < words; ++k) {
+            uint64_t d = bits[k] ^ bits[k + q];
+            if (k == words - 1)
+                d &= lastMask;
+            count += __builtin_popcountll(d);
         }
-        if (mAMDF[i] < Vmin) {
-            Vmin = mAMDF[i];
+    }
+    else {
+        for (int k = 0; k < words; ++k) {
+            const uint64_t shifted = (bits[k + q] >> r) | (bits[k + q + 1] << (64 - r));
+            uint64_t d = bits[k] ^ shifted;
+            if (k == words - 1)
+                d &= lastMask;
+            count += __builtin_popcountll(d);
         }
     }
 
-    // Convert to 1-bit AMDF.
-    const double theta = mAlpha * (Vmax + Vmin);
-
-    m1bAMDF.resize(maxShift / 32 + 1);
-
-    for (int k = 0; k < maxShift / 32 + 1; ++k) {
-        uint32_t v = 0u;
+    return count;
+}
 
-        for (int bit = 0; bit < 32; ++bit) {
-            int i = k * 32 + bit;
-            if (i < maxShift && mAMDF[i] <= theta) {
-                v |= 1u << bit;
-            }
-        }
+PitchResult AMDF_M::solve(const double *data, int length, int sampleRate)
+{
+    const int maxPeriod = std::min<int>(ceil(sampleRate / mMinPitch), length / 2);
+    const int minPeriod = std::max<int>(floor(sampleRate / mMaxPitch), 2);
 
-        m1bAMDF[k] = v;
+    if (maxPeriod <= minPeriod + 2) {
+        return {.pitch = 0.0, .voiced = false};
     }
 
-    // Calculate the ACF for the 1-bit AMDF signal.
-    m1bACF.resize(maxShift);
+    // Every lag compares the same window, which stays inside the frame.
+    const int window = length - maxPeriod - 1;
 
-    for (int i = 0; i < maxShift; ++i) {
-        int sum = 0;
-
-        for (int j = 0; j < maxShift - i; ++j) {
-            int aInd = j / 32;
-            int aBit = j % 32;
-
-            int bInd = (i + j) / 32;
-            int bBit = (i + j) % 32;
+    double mean = 0.0;
+    for (int i = 0; i < length; ++i) {
+        mean += data[i];
+    }
+    mean /= length;
+
+    // Sign-quantize the frame, one bit per sample, with a spare word for the shifted reads.
+    const int totalWords = (length + 63) / 64 + 1;
+    mBits.assign(totalWords, 0);
+    for (int i = 0; i < length; ++i) {
+        if (data[i] >= mean) {
+            mBits[i >> 6] |= uint64_t(1) << (i & 63);
+        }
+    }
 
-            if ((m1bAMDF[aInd] & (1u << aBit)) && (m1bAMDF[bInd] & (1u << bBit)))
-                sum++;
+    const int words = (window + 63) / 64;
+    const int tail = window & 63;
+    const uint64_t lastMask = tail ? (uint64_t(1) << tail) - 1 : ~uint64_t(0);
+
+    // One-bit correlation, 1 for identical signs over the window, -1 for opposite.
+    m1bACF.assign(maxPeriod + 1, 0.0);
+    double maxValue = -std::numeric_limits<double>::max();
+    for (int lag = minPeriod; lag <= maxPeriod; ++lag) {
+        const int disagreements = oneBitAMDF(mBits.data(), words, lastMask, lag);
+        m1bACF[lag] = 1.0 - (2.0 * disagreements) / window;
+        if (m1bACF[lag] > maxValue) {
+            maxValue = m1bACF[lag];
         }
+    }
 
-        m1bACF[i] = sum;
+    if (maxValue < coarseThreshold) {
+        return {.pitch = 0.0, .voiced = false};
     }
 
-    // Find the global peak.
+    // Shortest period close enough to the best one, to avoid octave errors downwards.
     rpm::vector<int> maxPositions = findPeaks(
             std::next(m1bACF.data(), minPeriod),
             maxPeriod - minPeriod + 1);
 
-    if (maxPositions.empty()) {
+    int coarse = -1;
+    for (const int pos : maxPositions) {
+        const int lag = minPeriod + pos;
+        if (m1bACF[lag] >= mAlpha * maxValue) {
+            coarse = lag;
+            break;
+        }
+    }
+
+    if (coarse < 0) {
         return {.pitch = 0.0, .voiced = false};
     }
 
-    const double actualCutoff = mAlpha * m1bACF[0];
+    // Full-precision refinement around the coarse estimate.
+    const int radius = std::max(2, coarse / 32);
+    rpm::set<int> lags;
+    for (int lag = std::max(minPeriod, coarse - radius - 1); lag <= std::min(maxPeriod, coarse + radius + 1); ++lag) {
+        lags.emplace(lag);
+    }
 
-    double pitch = 0.0;
+    mNCCF.computeLags(data, window, lags, maxPeriod, mNCCFValues);
 
-    for (const int pos : maxPositions) {
-        int i = minPeriod + pos;
+    int best = coarse;
+    for (int lag : lags) {
+        if (mNCCFValues[lag] > mNCCFValues[best]) {
+            best = lag;
+        }
+    }
 
-        if (m1bACF[i] >= actualCutoff) {
-            pitch = (double) sampleRate / (double) i;
+    if (mNCCFValues[best] < voicingThreshold) {
+        return {.pitch = 0.0, .voiced = false};
+    }
 
-            if (pitch >= mMinPitch && pitch <= mMaxPitch)
-                return {.pitch = pitch, .voiced = true};
-        }
+    double period = best;
+    if (lags.count(best - 1) && lags.count(best + 1)) {
+        period = std::get<0>(parabolicInterpolation(mNCCFValues, best));
+    }
+
+    const double pitch = sampleRate / period;
+
+    if (pitch < mMinPitch || pitch > mMaxPitch) {
+        return {.pitch = 0.0, .voiced = false};
     }
 
-    return pitch > 0.0 ? PitchResult {.pitch = pitch, .voiced = true}
-                       : PitchResult {.pitch = 0.0, .voiced = false};
+    return {.pitch = pitch, .voiced = true};
 }
@@ -1,19 +1,265 @@
 #include "../util/util.h"
-#include "../filter/filter.h"
-#include "../resampler/resampler.h"
-#include "../../modules/math/constants.h"
 #include "irapt/irapt.h"
 #include "pitch.h"
 #include <cmath>
 #include <algorithm>
-#include <numeric>
-#include <iostream>
-#include <set>
 
 using namespace Analysis;
 
+// Fraction of the best correlation a shorter lag needs to be preferred, and
+// a lag near the previous F0 needs to be kept.
+static constexpr double candidateRatio = 0.85;
+static constexpr double trackingRatio = 0.7;
+
+// Fraction of the harmonic power the F0 fit must explain for a voiced frame.
+static constexpr double voicingThreshold = 0.6;
+
+Pitch::IRAPT::IRAPT()
+    : mCfg(nullptr),
+      mFFT(nullptr),
+      mLastPitch(0.0)
+{
+}
+
+void Pitch::IRAPT::reset()
+{
+    mLastPitch = 0.0;
+}
+
 PitchResult Pitch::IRAPT::solve(const double *data, int length, int sampleRate)
 {
-    irapt1();
+    if (!mCfg || mCfg->fs != sampleRate) {
+        mCfg = sharedCfg(sampleRate);
+        mLastPitch = 0.0;
+    }
+
+    const int nfft = 1 << mCfg->corr_param.FFT_order;
+    if (!mFFT || (int) mFFT->getInputLength() != nfft) {
+        mFFT = std::make_unique<RealFFT>(nfft);
+    }
+
+    decimate(data, length);
+    analyseHarmonics();
+
+    if (mHarmonics.size() < 2) {
+        mLastPitch = 0.0;
+        return {.pitch = 0.0, .voiced = false};
+    }
+
+    computeCorrelation();
+
+    const auto& cp = mCfg->corr_param;
+
+    // Candidates run from the highest F0 (shortest lag) down.
+    double maxValue = 0.0;
+    for (int i = 0; i < cp.Actual_freqs_num; ++i) {
+        maxValue = std::max(maxValue, mCandidates[i]);
+    }
+
+    int best = -1;
+    int tracked = -1;
+    for (int i = 0; i < cp.Actual_freqs_num; ++i) {
+        const bool isPeak = (i == 0 || mCandidates[i] >= mCandidates[i - 1])
+                && (i == cp.Actual_freqs_num - 1 || mCandidates[i] >= mCandidates[i + 1]);
+        if (!isPeak) {
+            continue;
+        }
+        if (best < 0 && mCandidates[i] >= candidateRatio * maxValue) {
+            best = i;
+        }
+        if (mLastPitch > 0.0 && fabs(cp.Actual_freqs[i] - mLastPitch) <= mCfg->f0_max_step
+                && mCandidates[i] >= trackingRatio * maxValue
+                && (tracked < 0 || mCandidates[i] > mCandidates[tracked])) {
+            tracked = i;
+        }
+    }
+
+    // The correlation of a harmonic model is as high at multiples of the period,
+    // so continuity must not pull the estimate down to a subharmonic.
+    if (tracked >= 0 && best >= 0) {
+        const double ratio = cp.Actual_freqs[best] / cp.Actual_freqs[tracked];
+        const bool subharmonic = ratio > 1.5 && fabs(ratio - std::round(ratio)) < 0.1;
+        if (!subharmonic) {
+            best = tracked;
+        }
+    }
+
+    if (best < 0) {
+        mLastPitch = 0.0;
+        return {.pitch = 0.0, .voiced = false};
+    }
+
+    // Least-squares fit of f_h = h * F0 over the harmonics near multiples of the candidate.
+    const double coarse = cp.Actual_freqs[best];
+    double num = 0.0;
+    double den = 0.0;
+    double matched = 0.0;
+    double total = 0.0;
+
+    for (const auto& [power, frequency] : mHarmonics) {
+        total += power;
+
+        const int h = std::round(frequency / coarse);
+        if (h >= 1 && h <= mCfg->max_harmonic_number
+                && fabs(frequency - h * coarse) <= 0.2 * coarse) {
+            num += power * h * frequency;
+            den += power * h * h;
+            matched += power;
+        }
+    }
+
+    if (den <= 0.0 || matched < voicingThreshold * total) {
+        mLastPitch = 0.0;
+        return {.pitch = 0.0, .voiced = false};
+    }
+
+    const double pitch = num / den;
+
+    if (pitch < mCfg->f0_limits.first || pitch > mCfg->f0_limits.second) {
+        mLastPitch = 0.0;
+        return {.pitch = 0.0, .voiced = false};
+    }
+
+    mLastPitch = pitch;
+    return {.pitch = pitch, .voiced = true};
+}
+
+void Pitch::IRAPT::decimate(const double *data, int length)
+{
+    const auto& h = mCfg->src_filter;
+    const int taps = h.size();
+    const int ratio = mCfg->src_sub_ratio;
+
+    // One extra sample for the frame shifted by one step.
+    const int count = mCfg->frame_sub_smp + 1;
+    const int first = length / 2 - (mCfg->frame_sub_smp / 2) * ratio;
+
+    mSub.resize(count);
+
+    for (int m = 0; m < count; ++m) {
+        const int center = first + m * ratio;
+        double y = 0.0;
+        for (int i = 0; i < taps; ++i) {
+            const int j = center + taps / 2 - i;
+            if (j >= 0 && j < length) {
+                y += h[i] * data[j];
+            }
+        }
+        mSub[m] = y;
+    }
+}
+
+void Pitch::IRAPT::analyseHarmonics()
+{
+    const int M = mCfg->frame_sub_smp;
+    const int nfft = mFFT->getInputLength();
+    const int nout = mFFT->getOutputLength();
+    const double binWidth = mCfg->fs_f0 / nfft;
+    const auto& w = mCfg->frame_window;
+
+    // Spectra of the frame and of the frame one sample later: the phase
+    // advance at a line gives the instantaneous frequency it locks onto.
+    for (int i = 0; i < M; ++i) {
+        mFFT->input(i) = w[i] * mSub[i];
+    }
+    for (int i = M; i < nfft; ++i) {
+        mFFT->input(i) = 0.0;
+    }
+    mFFT->computeForward();
+
+    mSpectrum.resize(nout);
+    for (int k = 0; k < nout; ++k) {
+        mSpectrum[k] = mFFT->output(k);
+    }
+
+    for (int i = 0; i < M; ++i) {
+        mFFT->input(i) = w[i] * mSub[i + 1];
+    }
+    mFFT->computeForward();
+
+    mHarmonics.clear();
+
+    double maxPower = 0.0;
+
+    for (double F : mCfg->f0_freq_lines) {
+        const int k = std::round(F / binWidth);
+        if (k <= 0 || k >= nout) {
+            continue;
+        }
+
+        const std::dcomplex z = mFFT->output(k) * std::conj(mSpectrum[k]);
+        const double frequency = std::arg(z) * mCfg->fs_f0 / (2.0 * M_PI);
+        const double power = std::norm(mSpectrum[k]);
+
+        // A line only reports a harmonic that falls inside its band.
+        if (fabs(frequency - F) > mCfg->FD / 2.0) {
+            continue;
+        }
+
+        // Neighbouring lines overlap and lock onto the same harmonic, keep the strongest.
+        if (!mHarmonics.empty() && fabs(frequency - mHarmonics.back().frequency) < mCfg->FD / 2.0) {
+            if (power > mHarmonics.back().power) {
+                mHarmonics.back() = {power, frequency};
+            }
+        }
+        else {
+            mHarmonics.push_back({power, frequency});
+        }
+
+        maxPower = std::max(maxPower, power);
+    }
+
+    // Drop components more than 40 dB below the strongest one.
+    mHarmonics.erase(
+            std::remove_if(mHarmonics.begin(), mHarmonics.end(),
+                [maxPower](const Harmonic& hm) { return hm.power < 1e-4 * maxPower; }),
+            mHarmonics.end());
 }
 
+void Pitch::IRAPT::computeCorrelation()
+{
+    const auto& cp = mCfg->corr_param;
+    const int nfft = mFFT->getInputLength();
+    const int nout = mFFT->getOutputLength();
+    const double binWidth = mCfg->fs_f0 / nfft;
+
+    // Power spectrum of the harmonic model, lines split between the two nearest bins.
+    for (int k = 0; k < nout; ++k) {
+        mFFT->output(k) = 0.0;
+    }
+    for (const auto& [power, frequency] : mHarmonics) {
+        const double b = frequency / binWidth;
+        const int k = std::floor(b);
+        const double frac = b - k;
+        if (k >= 0 && k + 1 < nout) {
+            mFFT->output(k) += power * (1.0 - frac);
+            mFFT->output(k + 1) += power * frac;
+        }
+    }
+    mFFT->computeBackward();
+
+    const double r0 = mFFT->input(0);
+
+    mCorrelation.resize(cp.Right_index + 1);
+    for (int n = cp.Left_index; n <= cp.Right_index; ++n) {
+        mCorrelation[n] = r0 > 0.0 ? mFFT->input(n) / r0 : 0.0;
+    }
+
+    // Upsample the correlation only at the candidate lags.
+    const auto& h = cp.Interp_filter;
+    const int I = cp.Interp_factor;
+    const int hc = cp.Interp_filter_h_size * I;
+
+    mCandidates.resize(cp.Actual_freqs_num);
+    for (int i = 0; i < cp.Actual_freqs_num; ++i) {
+        const int m = cp.Actual_indices[i];
+        const int nmin = std::max(cp.Left_index, (m - hc + I - 1) / I);
+        const int nmax = std::min(cp.Right_index, (m + hc) / I);
+
+        double value = 0.0;
+        for (int n = nmin; n <= nmax; ++n) {
+            value += mCorrelation[n] * h[m - n * I + hc];
+        }
+        mCandidates[i] = value;
+    }
+}
@@ -1,10 +1,12 @@
 #include "irapt.h"
 #include <algorithm>
 #include <cmath>
+#include <mutex>
+#include <numeric>
 
 using namespace Analysis;
 
-static rpm::vector<double> fir1();
+static rpm::vector<double> fir1(int order, double cutoff);
 
 IRAPT_Cfg Analysis::initCfg(double sampleRate)
 {
@@ -12,7 +14,7 @@ IRAPT_Cfg Analysis::initCfg(double sampleRate)
 
     cfg.fs = sampleRate;
     cfg.fs_f0_target = 6000;
-    cfg.src_sub_ratio = std::round(cfg.fs / cfg.fs_f0_target);
+    cfg.src_sub_ratio = std::max<int>(1, std::round(cfg.fs / cfg.fs_f0_target));
     cfg.fs_f0 = cfg.fs / cfg.src_sub_ratio;
     cfg.FD = 35;
     cfg.max_harmonic_freq = 14000;
@@ -41,5 +43,87 @@ IRAPT_Cfg Analysis::initCfg(double sampleRate)
         F += cfg.FD / 2;
     }
 
-    cfg.corr_param
+    if (cfg.src_sub_ratio > 1) {
+        cfg.src_filter = fir1(8 * cfg.src_sub_ratio, 1.0 / cfg.src_sub_ratio);
+    }
+    else {
+        cfg.src_filter = { 1.0 };
+    }
+
+    cfg.frame_window.resize(cfg.frame_sub_smp);
+    for (int i = 0; i < cfg.frame_sub_smp; ++i) {
+        cfg.frame_window[i] = 0.5 - 0.5 * cos((2.0 * M_PI * i) / (cfg.frame_sub_smp - 1));
+    }
+
+    auto& cp = cfg.corr_param;
+
+    // About 3 Hz per bin, so that harmonic powers can be placed on the grid
+    // by linear interpolation without tapering the correlation noticeably.
+    cp.FFT_order = std::ceil(std::log2(cfg.fs_f0 / 3.0));
+    cp.FFT_freq_line_size = (1 << cp.FFT_order) / 2 + 1;
+
+    // The correlation is upsampled by Interp_factor around the lags of interest.
+    cp.Interp_factor = 4;
+    cp.Interp_filter_h_size = 8;
+    cp.Interp_filter = fir1(2 * cp.Interp_filter_h_size * cp.Interp_factor, 1.0 / cp.Interp_factor);
+    for (double& h : cp.Interp_filter) {
+        h *= cp.Interp_factor;
+    }
+
+    const double fsUp = cfg.fs_f0 * cp.Interp_factor;
+
+    // One lag per F0 candidate, rounded to the upsampled grid.
+    for (auto it = cfg.chunk_f0_freqs.rbegin(); it != cfg.chunk_f0_freqs.rend(); ++it) {
+        const int index = std::round(fsUp / *it);
+        if (cp.Actual_indices.empty() || cp.Actual_indices.back() != index) {
+            cp.Actual_indices.push_back(index);
+            cp.Actual_freqs.push_back(fsUp / index);
+        }
+    }
+    cp.Actual_freqs_num = cp.Actual_indices.size();
+
+    cp.Left_index_actual = cp.Actual_indices.front();
+    cp.Right_index_actual = cp.Actual_indices.back();
+    cp.Left_index = std::max(0, cp.Left_index_actual / cp.Interp_factor - cp.Interp_filter_h_size);
+    cp.Right_index = cp.Right_index_actual / cp.Interp_factor + cp.Interp_filter_h_size + 1;
+
+    return cfg;
+}
+
+std::shared_ptr<const IRAPT_Cfg> Analysis::sharedCfg(double sampleRate)
+{
+    static std::mutex mutex;
+    static rpm::map<double, std::shared_ptr<const IRAPT_Cfg>> cache;
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto it = cache.find(sampleRate);
+    if (it == cache.end()) {
+        it = cache.emplace(sampleRate, std::make_shared<const IRAPT_Cfg>(initCfg(sampleRate))).first;
+    }
+    return it->second;
+}
+
+// Hamming-windowed sinc lowpass of the given order, cutoff relative to Nyquist (as in MATLAB).
+rpm::vector<double> fir1(int order, double cutoff)
+{
+    const int n = order + 1;
+    const double center = order / 2.0;
+
+    rpm::vector<double> h(n);
+    double sum = 0.0;
+
+    for (int i = 0; i < n; ++i) {
+        const double t = i - center;
+        const double sinc = (t == 0.0) ? cutoff : sin(M_PI * cutoff * t) / (M_PI * t);
+        const double window = 0.54 - 0.46 * cos((2.0 * M_PI * i) / order);
+        h[i] = sinc * window;
+        sum += h[i];
+    }
+
+    for (double& x : h) {
+        x /= sum;
+    }
+
+    return h;
 }
@@ -2,6 +2,7 @@
 #define ANALYSIS_IRAPT_H
 
 #include "rpcxx.h"
+#include <memory>
 #include <utility>
 
 namespace Analysis {
@@ -30,6 +31,9 @@ namespace Analysis {
         double f0_max_step;
         rpm::vector<double> f0_freq_lines;
 
+        rpm::vector<double> src_filter;     // anti-aliasing filter for the decimation to fs_f0
+        rpm::vector<double> frame_window;   // analysis window, frame_sub_smp long
+
         struct {
             int FFT_order;
             int FFT_freq_line_size;
@@ -47,6 +51,9 @@ namespace Analysis {
     };
 
     IRAPT_Cfg initCfg(double sampleRate);
+
+    // Built once per sample rate and shared by every IRAPT instance.
+    std::shared_ptr<const IRAPT_Cfg> sharedCfg(double sampleRate);
 }
 
 #endif // ANALYSIS_IRAPT_H
@@ -3,7 +3,9 @@
 #include <complex>
 #include <float.h>
 #include <numeric>
+#include <stdexcept>
 #include "../util/util.h"
+#include "../util/parallel.h"
 
 #define MPM_CUTOFF 0.93
 #define MPM_SMALL_CUTOFF 0.5
@@ -15,10 +17,10 @@
 #define PMPM_CUTOFF_STEP 0.01
 
 template <typename T>
-static rpm::vector<int>
-peak_picking(const rpm::vector<T> &nsdf)
+static void
+peak_picking(const rpm::vector<T> &nsdf, rpm::vector<int> &max_positions)
 {
-	rpm::vector<int> max_positions{};
+	max_positions.clear();
 	int pos = 0;
 	int cur_max_pos = 0;
 	ssize_t size = nsdf.size();
@@ -50,68 +52,113 @@ peak_picking(const rpm::vector<T> &nsdf)
 	if (cur_max_pos > 0) {
 		max_positions.push_back(cur_max_pos);
 	}
-	return max_positions;
 }
 
-inline int
-pow2roundup (int x)
+Analysis::Pitch::MPM::MPM()
+    : mFFT(nullptr)
 {
-    if (x < 0)
-        return 0;
-    --x;
-    x |= x >> 1;
-    x |= x >> 2;
-    x |= x >> 4;
-    x |= x >> 8;
-    x |= x >> 16;
-    return x+1;
 }
 
-template <typename T>
 void
-acorr_r(rpm::vector<T> &audio_buffer)
+Analysis::Pitch::MPM::acorr_r(const double *data, int length)
 {
-	if (audio_buffer.size() == 0)
+	if (length == 0)
 		throw std::invalid_argument("audio_buffer shouldn't be empty");
 
-        const int N = audio_buffer.size();
-
-        int nfft = 2 * N - 1;
- 
-        static std::shared_ptr<Analysis::RealFFT> fft(nullptr);
+        // Padded to a fast size; any nfft >= 2N - 1 gives the linear autocorrelation.
+        const int N = length;
+        const int nfft = Analysis::nextFastLength(2 * N - 1);
 
-        if (!fft || fft->getInputLength() != nfft) {
-            fft.reset(new Analysis::RealFFT(nfft));
+        if (!mFFT || mFFT->getInputLength() != nfft) {
+            mFFT = std::make_unique<Analysis::RealFFT>(nfft);
         }
 
         for (int i = 0; i < N; ++i) {
-            fft->input(i) = audio_buffer[i];
+            mFFT->input(i) = data[i];
         }
         for (int i = N; i < nfft; ++i) {
-            fft->input(i) = 0.0;
+            mFFT->input(i) = 0.0;
         }
 
-        fft->computeForward();
+        mFFT->computeForward();
         
         for (int i = 0; i < nfft / 2 + 1; ++i) {
-            std::dcomplex z = fft->output(i);
-            fft->output(i) = (z * conj(z)) / (double) nfft;
+            std::dcomplex z = mFFT->output(i);
+            mFFT->output(i) = (z * conj(z)) / (double) nfft;
         }
-        fft->computeBackward();
+        mFFT->computeBackward();
 
+        mBuffer.resize(N);
         for (int i = 0; i < N; ++i) {
-            audio_buffer[i] = fft->input(i);
+            mBuffer[i] = mFFT->input(i);
         }
 }
 
 Analysis::PitchResult
 Analysis::Pitch::MPM::solve(const double *data, int length, int sample_rate)
 {
-    using T = double;
+	acorr_r(data, length);
+	return pickPitch(mBuffer, sample_rate, mMaxPositions, mEstimates);
+}
+
+void
+Analysis::Pitch::MPM::solveBatch(const double *frames, int count, int length, int stride, int sample_rate, Analysis::PitchResult *results)
+{
+	constexpr int kBlock = 16;
+
+	if (length == 0)
+		throw std::invalid_argument("audio_buffer shouldn't be empty");
+
+        const int N = length;
+        const int nfft = Analysis::nextFastLength(2 * N - 1);
+
+        Analysis::parallelFor(count, [&](int begin, int end) {
+            auto plan = mBatchFFTs.acquire(nfft, std::min(kBlock, end - begin));
+            Analysis::BatchRealFFT& fft = *plan;
+            const int outLength = fft.getOutputLength();
+
+            rpm::vector<double> acf(N);
+            rpm::vector<int> maxPositions;
+            rpm::vector<std::pair<double, double>> estimates;
+
+            for (int first = begin; first < end; first += fft.getCount()) {
+                const int block = std::min(fft.getCount(), end - first);
+
+                for (int f = 0; f < fft.getCount(); ++f) {
+                    const double *x = frames + (first + f) * stride;
+                    for (int i = 0; i < N; ++i)
+                        fft.input(f, i) = f < block ? x[i] : 0.0;
+                    for (int i = N; i < nfft; ++i)
+                        fft.input(f, i) = 0.0;
+                }
+
+                fft.computeForward();
+                for (int f = 0; f < fft.getCount(); ++f) {
+                    for (int i = 0; i < outLength; ++i) {
+                        std::dcomplex z = fft.output(f, i);
+                        fft.output(f, i) = (z * conj(z)) / (double) nfft;
+                    }
+                }
+                fft.computeBackward();
+
+                for (int f = 0; f < block; ++f) {
+                    for (int i = 0; i < N; ++i)
+                        acf[i] = fft.input(f, i);
+                    results[first + f] = pickPitch(acf, sample_rate, maxPositions, estimates);
+                }
+            }
+
+            mBatchFFTs.release(std::move(plan));
+        });
+}
 
-    rpm::vector<T> audio_buffer(data, data + length);
+Analysis::PitchResult
+Analysis::Pitch::MPM::pickPitch(rpm::vector<double>& audio_buffer, int sample_rate,
+                rpm::vector<int>& max_positions, rpm::vector<std::pair<double, double>>& estimates)
+{
+    using T = double;
 
-	acorr_r(audio_buffer);
+        const int length = audio_buffer.size();
 
         double max = 0.02;
         for (int i = 0; i < length; ++i) {
@@ -124,8 +171,8 @@ Analysis::Pitch::MPM::solve(const double *data, int length, int sample_rate)
             audio_buffer[i] /= max;
         }
 
-	rpm::vector<int> max_positions = peak_picking(audio_buffer);
-	rpm::vector<std::pair<T, T>> estimates;
+	peak_picking(audio_buffer, max_positions);
+	estimates.clear();
 
 	T highest_amplitude = -DBL_MAX;
 
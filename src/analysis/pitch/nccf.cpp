@@ -0,0 +1,88 @@
+#include "nccf.h"
+#include <Eigen/Dense>
+#include <cmath>
+
+using namespace Analysis;
+
+NCCF::NCCF()
+    : mFFT(nullptr)
+{
+}
+
+void NCCF::compute(const double *s, int n, int kmin, int kmax, rpm::vector<double>& nccf)
+{
+    const int length = n + kmax;
+
+    // Negative lags wrap to the end of the buffer and never reach [0, kmax].
+    const int nfft = nextFastLength(length);
+
+    if (!mFFT || (int) mFFT->getInputLength() != nfft) {
+        mFFT = std::make_unique<RealFFT>(nfft);
+        mSpectrum.resize(mFFT->getOutputLength());
+    }
+
+    const int nout = mFFT->getOutputLength();
+
+    for (int j = 0; j < n; ++j) {
+        mFFT->input(j) = s[j];
+    }
+    for (int j = n; j < nfft; ++j) {
+        mFFT->input(j) = 0.0;
+    }
+    mFFT->computeForward();
+    for (int k = 0; k < nout; ++k) {
+        mSpectrum[k] = std::conj(mFFT->output(k));
+    }
+
+    for (int j = 0; j < length; ++j) {
+        mFFT->input(j) = s[j];
+    }
+    for (int j = length; j < nfft; ++j) {
+        mFFT->input(j) = 0.0;
+    }
+    mFFT->computeForward();
+    for (int k = 0; k < nout; ++k) {
+        mFFT->output(k) *= mSpectrum[k];
+    }
+    mFFT->computeBackward();
+
+    computeEnergies(s, length);
+
+    nccf.assign(kmax + 1, 0.0);
+    for (int k = std::max(kmin, 0); k <= kmax; ++k) {
+        nccf[k] = normalize(mFFT->input(k) / nfft, n, k);
+    }
+}
+
+void NCCF::computeLags(const double *s, int n, const rpm::set<int>& lags, int kmax, rpm::vector<double>& nccf)
+{
+    computeEnergies(s, n + kmax);
+
+    Eigen::Map<const Eigen::VectorXd> x(s, n);
+
+    nccf.assign(kmax + 1, 0.0);
+    for (int k : lags) {
+        if (k >= 0 && k <= kmax) {
+            const double p = x.dot(Eigen::Map<const Eigen::VectorXd>(s + k, n));
+            nccf[k] = normalize(p, n, k);
+        }
+    }
+}
+
+void NCCF::computeEnergies(const double *s, int length)
+{
+    mEnergy.resize(length + 1);
+    mEnergy[0] = 0.0;
+    for (int j = 0; j < length; ++j) {
+        mEnergy[j + 1] = mEnergy[j] + s[j] * s[j];
+    }
+}
+
+double NCCF::normalize(double p, int n, int k) const
+{
+    const double e0 = mEnergy[n] - mEnergy[0];
+    const double ek = mEnergy[k + n] - mEnergy[k];
+    const double q = std::sqrt(std::max(e0 * ek, 0.0));
+
+    return q > 0.0 ? p / q : 0.0;
+}
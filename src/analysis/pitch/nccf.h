@@ -0,0 +1,41 @@
+#ifndef ANALYSIS_PITCH_NCCF_H
+#define ANALYSIS_PITCH_NCCF_H
+
+#include "rpcxx.h"
+#include "../fft/fft.h"
+#include <memory>
+
+namespace Analysis {
+
+    /*
+     *  Normalized cross-correlation of the window s[0, n) with s[k, k + n).
+     *
+     *  The full lag range is computed with one FFT cross-correlation, and
+     *  the energy of every shifted window comes from prefix sums of s^2.
+     *  A sparse set of lags can instead be evaluated with direct dot products,
+     *  which is cheaper when only a few candidates need refining.
+     *
+     *  The input must hold at least n + kmax samples.
+     */
+    class NCCF {
+    public:
+        NCCF();
+
+        // Fills nccf[0, kmax], lags below kmin are set to zero.
+        void compute(const double *s, int n, int kmin, int kmax, rpm::vector<double>& nccf);
+
+        // Fills nccf[0, kmax] at the given lags only, zero elsewhere.
+        void computeLags(const double *s, int n, const rpm::set<int>& lags, int kmax, rpm::vector<double>& nccf);
+
+    private:
+        void computeEnergies(const double *s, int length);
+        double normalize(double p, int n, int k) const;
+
+        std::unique_ptr<RealFFT> mFFT;
+        rpm::vector<std::dcomplex> mSpectrum;
+        rpm::vector<double> mEnergy;
+    };
+
+}
+
+#endif // ANALYSIS_PITCH_NCCF_H
@@ -2,10 +2,13 @@
 #define ANALYSIS_PITCH_H
 
 #include "rpcxx.h"
+#include <Eigen/Dense>
 #include <cstdint>
 #include <memory>
 
 #include "../fft/fft.h"
+#include "irapt/irapt.h"
+#include "nccf.h"
 #include "rapt.h"
 
 namespace Analysis {
@@ -19,10 +22,33 @@ namespace Analysis {
     public:
         virtual ~PitchSolver() {}
         virtual PitchResult solve(const double *data, int length, int sampleRate) = 0;
+
+        // Number of frames by which the results lag behind the frames passed to solve().
+        virtual int getFrameDelay() const { return 0; }
+
+        // Drops any state carried over from previously solved frames.
+        virtual void reset() {}
+
+        // Samples from the start of the previous frame to the start of the next one given
+        // to solve(), 0 if they are unrelated. Only applies to that next call.
+        virtual void setFrameHop(int hop) {}
+
+        // Frame i starts at frames + i * stride. Frames are solved in order, so results
+        // lag behind by getFrameDelay() exactly as with successive calls to solve().
+        virtual void solveBatch(const double *frames, int count, int length, int stride, int sampleRate, PitchResult *results)
+        {
+            for (int i = 0; i < count; ++i)
+                results[i] = solve(frames + i * stride, length, sampleRate);
+        }
     };
 
     namespace Pitch {
         /*
+         *  One-bit AMDF: the frame is reduced to the signs of its samples, packed
+         *  64 to a word, so the AMDF at each lag is a popcount of XORed words.
+         *  The shortest lag whose one-bit correlation is within alpha of the best
+         *  one seeds a full-precision NCCF search over a few neighbouring lags.
+         */
         class AMDF_M : public PitchSolver {
         public:
             AMDF_M(double minPitch, double maxPitch, double alpha);
@@ -31,11 +57,11 @@ namespace Analysis {
             double mMinPitch;
             double mMaxPitch;
             double mAlpha;
-            rpm::vector<double> mAMDF;
-            rpm::vector<uint32_t> m1bAMDF;
+            rpm::vector<uint64_t> mBits;
             rpm::vector<double> m1bACF;
+            NCCF mNCCF;
+            rpm::vector<double> mNCCFValues;
         };
-        */
 
         class Yin : public PitchSolver {
         public:
@@ -49,26 +75,94 @@ namespace Analysis {
             rpm::vector<double> mCMND;
         };
 
+        /*
+         *  YIN on the exact difference function, restricted to the lags of
+         *  the [minPitch, maxPitch] range. The lag-zero window is correlated
+         *  with the whole frame through a real-input FFT, the energy terms
+         *  follow from a running sum, and the detected lag is refined by
+         *  parabolic interpolation of the CMND.
+         *
+         *  Frames are expected to overlap with short hops, as served by the
+         *  pipeline's framers, so the plan and buffers are kept per length.
+         */
+        class StreamingYin : public PitchSolver {
+        public:
+            StreamingYin(double threshold, double minPitch, double maxPitch);
+            PitchResult solve(const double *data, int length, int sampleRate) override;
+        private:
+            double mThreshold;
+            double mMinPitch;
+            double mMaxPitch;
+            std::unique_ptr<RealFFT> mFFT;
+            rpm::vector<std::dcomplex> mSpectrum;
+            Eigen::ArrayXd mCorrelation;
+            Eigen::ArrayXd mEnergy;
+            Eigen::ArrayXd mDifference;
+            Eigen::ArrayXd mCumulative;
+            Eigen::ArrayXd mCMND;
+        };
+
         class MPM : public PitchSolver {
         public:
+            MPM();
             PitchResult solve(const double *data, int length, int sampleRate) override;
+            void solveBatch(const double *frames, int count, int length, int stride, int sampleRate, PitchResult *results) override;
+        private:
+            void acorr_r(const double *data, int length);
+            static PitchResult pickPitch(rpm::vector<double>& acf, int sampleRate,
+                    rpm::vector<int>& maxPositions, rpm::vector<std::pair<double, double>>& estimates);
+
+            std::unique_ptr<RealFFT> mFFT;
+            BatchRealFFTPool mBatchFFTs;
+            rpm::vector<double> mBuffer;
+            rpm::vector<int> mMaxPositions;
+            rpm::vector<std::pair<double, double>> mEstimates;
         };
 
         class RAPT : public PitchSolver, public Analysis::RAPT {
         public:
-            RAPT();
+            RAPT(int lookahead = 0);
             PitchResult solve(const double *data, int length, int sampleRate) override;
+            int getFrameDelay() const override;
+            void reset() override;
+            void setFrameHop(int hop) override;
         private:
             rpm::vector<double> pitches;
         };
 
         /*
+         *  Instantaneous pitch in the IRAPT framework. The frame centre is
+         *  decimated to about 6 kHz and analysed along overlapping frequency
+         *  lines, each giving the amplitude and instantaneous frequency of the
+         *  harmonic it locks onto. F0 candidates come from the autocorrelation
+         *  of that harmonic model, the chosen one follows the previous frame
+         *  within f0_max_step, and is refined to a least-squares fit of the
+         *  harmonics' instantaneous frequencies.
+         */
         class IRAPT : public PitchSolver {
         public:
             IRAPT();
             PitchResult solve(const double *data, int length, int sampleRate) override;
+            void reset() override;
+        private:
+            struct Harmonic {
+                double power;
+                double frequency;
+            };
+
+            void decimate(const double *data, int length);
+            void analyseHarmonics();
+            void computeCorrelation();
+
+            std::shared_ptr<const IRAPT_Cfg> mCfg;
+            std::unique_ptr<RealFFT> mFFT;
+            rpm::vector<double> mSub;
+            rpm::vector<std::dcomplex> mSpectrum;
+            rpm::vector<Harmonic> mHarmonics;
+            rpm::vector<double> mCorrelation;
+            rpm::vector<double> mCandidates;
+            double mLastPitch;
         };
-        */
     }
 
 }
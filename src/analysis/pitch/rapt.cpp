@@ -2,7 +2,6 @@
 #include "../filter/filter.h"
 #include "rapt.h"
 #include "pitch.h"
-#include <soxr.h>
 #include <cmath>
 #include <algorithm>
 #include <numeric>
@@ -10,7 +9,7 @@
 
 using namespace Analysis;
 
-Pitch::RAPT::RAPT()
+Pitch::RAPT::RAPT(int lookahead)
 {
     F0min   = 50;
     F0max   = 600;
@@ -25,7 +24,22 @@ Pitch::RAPT::RAPT()
     a_fact  = 10000;
     n_cands = 20;
 
-    nbFrames = 1;
+    this->lookahead = lookahead;
+}
+
+int Pitch::RAPT::getFrameDelay() const
+{
+    return lookahead;
+}
+
+void Pitch::RAPT::reset()
+{
+    resetPath();
+}
+
+void Pitch::RAPT::setFrameHop(int hop)
+{
+    setHop(hop);
 }
 
 PitchResult Pitch::RAPT::solve(const double *data, int length, int sampleRate)
@@ -46,15 +60,11 @@ PitchResult Pitch::RAPT::solve(const double *data, int length, int sampleRate)
     }
 }
 
-static void subtractReferenceMean(rpm::vector<double>& s, int n, int K);
-
-static rpm::vector<double> downsampleSignal(const rpm::vector<double>& s, const double Fs, const double Fds);
-
-static rpm::vector<double> calculateDownsampledNCCF(const rpm::vector<double>& dss, const int dsn, const int dsK1, const int dsK2);
+static double subtractReferenceMean(rpm::vector<double>& s, int n, int K);
 
 static rpm::vector<std::pair<double, double>> findPeaksWithThreshold(const rpm::vector<double>& nccf, const double cand_tr, const int n_cands, const bool paraInterp);
 
-static rpm::vector<double> calculateOriginalNCCF(const rpm::vector<double>& s, const double Fs, const double Fds, const int n, const int K, const rpm::vector<std::pair<double, double>>& dsPeaks);
+static rpm::vector<double> calculateOriginalNCCF(NCCF& engine, const rpm::vector<double>& s, const double Fs, const double Fds, const int n, const int K, const rpm::vector<std::pair<double, double>>& dsPeaks);
 
 static rpm::vector<RAPT::Cand> createCosts(const rpm::vector<std::pair<double, double>>& peaks, const double vo_bias, const double beta);
 
@@ -68,12 +78,21 @@ static rpm::vector<double> lpcar2rf(const rpm::vector<double>& ar);
 static rpm::vector<double> lpcrf2rr(const rpm::vector<double>& rf);
 
 RAPT::RAPT()
-    : lpcOrder(-1)
+    : lookahead(0),
+      lpcOrder(-1),
+      decimatorFactor(0),
+      nextHop(0),
+      lastLength(0)
 {
 }
 
 double RAPT::computeFrame(const double *data, int length, double Fs)
 {
+    if (!frames.empty() && frames.back().Fs != Fs) {
+        resetPath();
+        lpcOrder = -1;
+    }
+
     if (lpcOrder < 0) {
         lpcOrder = 2 + std::round(Fs / 1000);
     }
@@ -83,182 +102,231 @@ double RAPT::computeFrame(const double *data, int length, double Fs)
     const int n = std::round(w * Fs);
     const int K = std::round(Fs / F0min);
 
-    const double Fds = std::round(Fs / std::round(Fs / (4.0 * F0max)));
+    // An integer factor keeps every downsampled sample on an input sample.
+    const int factor = std::max<int>(1, std::round(Fs / (4.0 * F0max)));
+    const double Fds = Fs / factor;
     const int dsn = std::round(w * Fds);
     const int dsK1 = std::round(Fds / F0max);
     const int dsK2 = std::round(Fds / F0min);
 
     const double beta = lag_wt / (Fs / F0min);
     
-    const int J = std::round(0.03 * Fs);
-
     rpm::vector<double> s(data, data + length);
     
     if (s.size() < n + K) {
         s.resize(n + K, 0.0);
     }
 
-    subtractReferenceMean(s, n, K);
+    const int J = std::min<int>(std::round(0.03 * Fs), s.size());
 
-    auto dss = downsampleSignal(s, Fs, Fds);
-    
-    if (dss.size() < dsn + dsK2) {
-        dss.resize(dsn + dsK2, 0.0);
-    }
+    const double mu = subtractReferenceMean(s, n, K);
+
+    auto& dss = dsBuffer;
+    dss.resize(dsn + dsK2);
+    decimate(data, length, mu, factor, dss);
     
-    auto dsNCCF = calculateDownsampledNCCF(dss, dsn, dsK1, dsK2);
+    rpm::vector<double> dsNCCF;
+    nccfDownsampled.compute(dss.data(), dsn, dsK1, dsK2, dsNCCF);
     auto dsPeaks = findPeaksWithThreshold(dsNCCF, cand_tr, n_cands, true);
    
     rpm::vector<std::pair<double, double>> peaks;
    
     rpm::vector<double> nccf;
     if (dsPeaks.size() > 0) {
-        nccf = calculateOriginalNCCF(s, Fs, Fds, n, K, dsPeaks);
+        nccf = calculateOriginalNCCF(nccfOriginal, s, Fs, Fds, n, K, dsPeaks);
         peaks = findPeaksWithThreshold(nccf, cand_tr, n_cands, false);
     }
 
-    if (frames.size() != nbFrames) {
-        Frame defaultFrame = {
-            .cands = { { .localCost = vo_bias, .voiced = false } },
-            .rms = 1e-10,
-            .rr = 1.0,
-            .ar = { 1.0 },
-            .S = -0.25,
-        };
-        frames.resize(nbFrames, defaultFrame);
-    }
-
     Frame frm;
     frm.Fs = Fs;
     frm.cands = createCosts(peaks, vo_bias, beta);
-  
-    if (nbFrames > 1) {
-        frm.rms = calculateRMS(s, length / 2 - J / 2, J);
-        frm.rr = frm.rms / frames.back().rms;
-    
-        // Pre-emphasis.
-        const double alpha = expf(-7000 / Fs);
-        for (int i = s.size() - 1; i >= 1; --i) {
-            s[i] -= alpha * s[i - 1];
+
+    for (auto& cand : frm.cands) {
+        if (cand.voiced) {
+            cand.L = std::get<0>(parabolicInterpolation(nccf, cand.L));
         }
+    }
 
-        // Calculate AR.
-        double gain;
-        frm.ar = lpc.solve(s.data(), s.size(), lpcOrder, &gain);
-        frm.ar.insert(frm.ar.begin(), 1.0);
+    frm.rms = std::max(calculateRMS(s, std::max(0, length / 2 - J / 2), J), 1e-10);
+
+    // Pre-emphasis.
+    const double alpha = exp(-7000 / Fs);
+    for (int i = s.size() - 1; i >= 1; --i) {
+        s[i] -= alpha * s[i - 1];
+    }
+
+    // Calculate AR.
+    double gain;
+    frm.ar = lpc.solve(s.data(), s.size(), lpcOrder, &gain);
+    frm.ar.insert(frm.ar.begin(), 1.0);
+
+    if (!frames.empty()) {
+        frm.rr = frm.rms / frames.back().rms;
         frm.S = 0.2 / (expDistItakura(frm.ar, frames.back().ar) - 0.8);
     }
+    else {
+        frm.rr = 1.0;
+        frm.S = 0.0;
+    }
 
-    double pitch = 0.0;
-    
-    if (frm.cands[0].voiced) {
-        double Linterp = std::get<0>(parabolicInterpolation(nccf, frm.cands[0].L));
-        pitch = frm.Fs / Linterp;
+    decodeFrame(frm);
+
+    if (frames.size() < lookahead + 1) {
+        return 0.0;
     }
 
-    frames.pop_front();
-    frames.push_back(std::move(frm));
+    // Backtrack from the best hypothesis of the newest frame to the oldest one.
+    int j = std::distance(D.begin(), std::min_element(D.begin(), D.end()));
+    for (int i = frames.size() - 1; i > 0; --i) {
+        j = frames[i].back[j];
+    }
 
-    return pitch;
+    const auto& best = frames.front().cands[j];
+    return best.voiced ? frames.front().Fs / best.L : 0.0;
 }
 
-rpm::vector<double> RAPT::computePath()
+void RAPT::resetPath()
 {
-    static rpm::vector<rpm::vector<rpm::vector<double>>> transitionMatrices;
-
-    transitionMatrices.resize(nbFrames);
-
-    for (int i = 1; i < nbFrames; ++i) {
-        const int nj = frames[i].cands.size();
-        const int nk = frames[i - 1].cands.size();
+    frames.clear();
+    D.clear();
+    lastLength = 0;
+}
 
-        auto& mat = transitionMatrices[i];
-        mat.resize(nj);
+void RAPT::setHop(int hop)
+{
+    nextHop = hop;
+}
 
-        const double rri = frames[i].rr;
-        const double Si = frames[i].S;
-        
-        for (int j = 0; j < nj; ++j) {
-            auto& row = mat[j];
-            row.resize(nk);
-            
-            const auto& cj = frames[i].cands[j];
+double RAPT::transitionCost(const Cand& ck, const Cand& cj, double rr, double S) const
+{
+    if (cj.voiced && ck.voiced) { // Voiced to voiced
+        double xi = fabs(log(cj.L / ck.L));
+        return freq_wt * std::min(xi, doubl_c + fabs(xi - M_LN2));
+    }
+    else if (!cj.voiced && ck.voiced) { // Voiced to unvoiced
+        return vtran_c + vtr_s_c * S + vtr_a_c * rr;
+    }
+    else if (cj.voiced && !ck.voiced) { // Unvoiced to voiced
+        return vtran_c + vtr_s_c * S + vtr_a_c / rr;
+    }
+    else { // Unvoiced to unvoiced
+        return 0.0;
+    }
+}
 
-            for (int k = 0; k < nk; ++k) {
+void RAPT::decodeFrame(Frame& frm)
+{
+    const int nj = frm.cands.size();
 
-                const auto& ck = frames[i - 1].cands[k];
+    frm.back.assign(nj, 0);
+    Dnext.resize(nj);
 
-                if (cj.voiced && ck.voiced) { // Voiced to voiced
-                    double xi = fabsf(logf(cj.L / ck.L));
-                    row[k] = freq_wt * std::min((double) xi, (doubl_c + fabs(xi - M_LN2)));
-                }
-                else if (!cj.voiced && ck.voiced) { // Voiced to unvoiced
-                    row[k] = vtran_c + vtr_s_c * Si + vtr_a_c * rri;
-                }
-                else if (cj.voiced && !ck.voiced) { // Unvoiced to voiced
-                    row[k] = vtran_c + vtr_s_c * Si + vtr_a_c / rri;
-                }
-                else { // Unvoiced to unvoiced
-                    row[k] = 0.0;
-                }
-            }
+    if (frames.empty()) {
+        for (int j = 0; j < nj; ++j) {
+            Dnext[j] = frm.cands[j].localCost;
         }
     }
+    else {
+        const auto& prev = frames.back();
+        const int nk = prev.cands.size();
 
-    static rpm::vector<rpm::vector<double>> D;
-    static rpm::vector<rpm::vector<int>> ks;
-    
-    D.resize(nbFrames + 1);
-    D[0].resize(2, 0.0);
-
-    ks.resize(nbFrames);
-
-    for (int i = 0; i < nbFrames; ++i) {
-        D[i + 1].resize(frames[i].cands.size());
-        ks[i].resize(frames[i].cands.size());
-
-        for (int j = 0; j < frames[i].cands.size(); ++j) {
-            double min = HUGE_VALF;
-            int kmin;
-            for (int k = 0; k < D[i].size(); ++k) {
-                double val = D[i][k] + i > 0 ? transitionMatrices[i][j][k] : 0.0;
+        for (int j = 0; j < nj; ++j) {
+            double min = HUGE_VAL;
+            int kmin = 0;
+            for (int k = 0; k < nk; ++k) {
+                double val = D[k] + transitionCost(prev.cands[k], frm.cands[j], frm.rr, frm.S);
                 if (val < min) {
                     min = val;
                     kmin = k;
                 }
             }
-            
-            D[i + 1][j] = frames[i].cands[j].localCost + min;
-            ks[i][j] = kmin;
+
+            Dnext[j] = frm.cands[j].localCost + min;
+            frm.back[j] = kmin;
         }
     }
 
-    rpm::vector<double> pitches(nbFrames);
- 
-    const int nj = D[1].size();
+    // Only differences between hypotheses matter, keep the costs bounded.
+    const double offset = *std::min_element(Dnext.begin(), Dnext.end());
+    for (double& d : Dnext) {
+        d -= offset;
+    }
+    std::swap(D, Dnext);
 
-    rpm::vector<int> indices(nj);
-    std::iota(indices.begin(), indices.end(), 0);
+    frames.push_back(std::move(frm));
+    while (frames.size() > lookahead + 1) {
+        frames.pop_front();
+    }
+}
 
-    std::sort(indices.begin(), indices.end(),
-            [&](int j, int k) { return D[1][j] < D[1][k]; });
+void RAPT::decimate(const double *data, int length, double mu, int factor, rpm::vector<double>& dss)
+{
+    if (decimatorFactor != factor) {
+        // Blackman-windowed sinc cutting off at 0.9 times the new Nyquist frequency,
+        // four output periods each side, normalised to unit gain at DC.
+        const int half = 4 * factor;
+        const double fc = 0.45 / factor;
+
+        decimatorKernel.resize(2 * half + 1);
+        double sum = 0.0;
+        for (int t = -half; t <= half; ++t) {
+            const double sinc = (t == 0) ? 2.0 * fc : sin(2.0 * M_PI * fc * t) / (M_PI * t);
+            const double phase = M_PI * t / (half + 1);
+            const double window = 0.42 + 0.5 * cos(phase) + 0.08 * cos(2.0 * phase);
+            decimatorKernel[t + half] = sinc * window;
+            sum += decimatorKernel[t + half];
+        }
+        for (double& h : decimatorKernel) {
+            h /= sum;
+        }
 
-    int k = indices[0];
+        decimatorFactor = factor;
+        lastLength = 0;
+    }
 
-    pitches[0] = frames[0].cands[k].voiced ? frames[0].Fs / frames[0].cands[k].L : 0.0;
+    const int half = decimatorKernel.size() / 2;
 
-    for (int i = 1; i < nbFrames; ++i) {
-        k = ks[i][k];
-        
-        pitches[i] = frames[i].cands[k].voiced ? frames[i].Fs / frames[i].cands[k].L : 0.0;
+    // Only a hop within the previous frame makes this frame its continuation.
+    const int hop = (nextHop > 0 && nextHop <= length && length == lastLength) ? nextHop : 0;
+    nextHop = 0;
+    lastLength = length;
+
+    // The mean is removed before filtering. Samples past either end of the frame
+    // read as zero, as they did when each frame was resampled on its own.
+    auto sample = [&](int i) {
+        if (i >= length) {
+            return 0.0;
+        }
+        if (i >= 0) {
+            return data[i] - mu;
+        }
+        return (hop > 0 && i + hop >= 0) ? lastFrame[i + hop] - mu : 0.0;
+    };
+
+    for (int i = 0; i < dss.size(); ++i) {
+        const int centre = i * factor;
+        double y = 0.0;
+        if (centre - half >= 0 && centre + half < length) {
+            const double *x = data + centre - half;
+            for (int t = 0; t <= 2 * half; ++t) {
+                y += decimatorKernel[t] * x[t];
+            }
+            y -= mu;
+        }
+        else {
+            for (int t = -half; t <= half; ++t) {
+                y += decimatorKernel[t + half] * sample(centre + t);
+            }
+        }
+        dss[i] = y;
     }
 
-    return pitches;
+    lastFrame.assign(data, data + length);
 }
 
 // utility functions.
 
-void subtractReferenceMean(rpm::vector<double>& s, int n, int K)
+double subtractReferenceMean(rpm::vector<double>& s, int n, int K)
 {
     double mu = 0.0;
     for (int j = 0; j < n; ++j)
@@ -266,55 +334,7 @@ void subtractReferenceMean(rpm::vector<double>& s, int n, int K)
     mu /= (double) n;
     for (int j = 0; j < s.size(); ++j) 
         s[j] -= mu;
-}
-
-rpm::vector<double> downsampleSignal(const rpm::vector<double>& s, const double Fs, const double Fds)
-{
-    size_t odone, olen = s.size() * Fds / Fs + 0.5;
-
-    rpm::vector<double> out(olen);
-
-    auto ioSpec = soxr_io_spec(SOXR_FLOAT64_I, SOXR_FLOAT64_I);
-    
-    soxr_oneshot(Fs, Fds, 1,
-        s.data(), s.size(), nullptr,
-        out.data(), olen, &odone,
-        &ioSpec,
-        nullptr,
-        nullptr);
-    
-    out.resize(odone);
-
-    return out;
-}
-
-rpm::vector<double> calculateDownsampledNCCF(const rpm::vector<double>& dss, const int dsn, const int dsK1, const int dsK2)
-{
-    rpm::vector<double> dsNCCF(dsK2 + 1, 0.0);
-
-    double dse0;
-    for (int l = 0; l < dsn; ++l) {
-        dse0 += dss[l] * dss[l];
-    }
-
-    for (int k = dsK1; k <= dsK2; ++k) {
-        double p, q;
-        p = q = 0.0;
-
-        for (int j = 0; j < dsn; ++j) {
-            p += dss[j] * dss[j + k];
-        }
-
-        for (int l = k; l < k + dsn; ++l) {
-            q += dss[l] * dss[l];
-        }
-
-        q = sqrtf(dse0 * q);
-
-        dsNCCF[k] = p / q;
-    }
-
-    return dsNCCF;
+    return mu;
 }
 
 rpm::vector<std::pair<double, double>> findPeaksWithThreshold(const rpm::vector<double>& nccf, const double cand_tr, const int n_cands, const bool paraInterp)
@@ -353,7 +373,7 @@ rpm::vector<std::pair<double, double>> findPeaksWithThreshold(const rpm::vector<
     return peaks;
 }
 
-rpm::vector<double> calculateOriginalNCCF(const rpm::vector<double>& s, const double Fs, const double Fds, const int n, const int K, const rpm::vector<std::pair<double, double>>& dsPeaks)
+rpm::vector<double> calculateOriginalNCCF(NCCF& engine, const rpm::vector<double>& s, const double Fs, const double Fds, const int n, const int K, const rpm::vector<std::pair<double, double>>& dsPeaks)
 {
     rpm::set<int> lagsToCalculate;
     for (const auto& [dsk, y] : dsPeaks) {
@@ -371,34 +391,8 @@ rpm::vector<double> calculateOriginalNCCF(const rpm::vector<double>& s, const do
         }
     }
     
-    rpm::vector<double> nccf(K + 1, 0.0);
-
-    double e0;
-    {
-        int j = 0;
-        double v = 0.0;
-        for (int l = j; l < j + n; ++l) {
-            v += s[l] * s[l];
-        }
-        e0 = v;
-    }
-
-    for (const int& k : lagsToCalculate) {
-        double p, q;
-        p = q = 0.0;
-
-        for (int j = 0; j < n; ++j) {
-            p += s[j] * s[j + k];
-        }
-
-        for (int l = k; l < k + n; ++l) {
-            q += s[l] * s[l];
-        }
-
-        q = sqrtf(e0 * q);
-
-        nccf[k] = p / q;
-    }
+    rpm::vector<double> nccf;
+    engine.computeLags(s.data(), n, lagsToCalculate, K, nccf);
     
     return nccf;
 }
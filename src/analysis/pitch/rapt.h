@@ -3,6 +3,7 @@
 
 #include "rpcxx.h"
 #include "../linpred/linpred.h"
+#include "nccf.h"
 
 namespace Analysis {
 
@@ -10,8 +11,15 @@ namespace Analysis {
     public:
         RAPT();
 
+        // Returns the F0 decoded for the frame given `lookahead` calls earlier,
+        // 0 if unvoiced or while the decoder window is still filling up.
         double computeFrame(const double *data, int length, double sampleRate);
-        rpm::vector<double> computePath();
+        void resetPath();
+
+        // The next frame starts hop samples after the previous one, which lets the
+        // decimator read the samples before it from the previous frame. 0 if they
+        // are unrelated.
+        void setHop(int hop);
 
         double F0min;    // minimum F0 to search for (Hz)                | 50
         double F0max;    // maximum F0 to search for (Hz)                | 500
@@ -25,6 +33,7 @@ namespace Analysis {
         double doubl_c;  // cost of exact F0 doubling of halving         | 0.35
         double a_fact;   // term to decrease PHI of weak signals         | 10000
         int   n_cands;  // max. number of hypotheses at each frame      | 20
+        int   lookahead; // frames decoded past the emitted one          | 0
 
         struct Cand {
             double localCost; // local cost of candidate for dynamic programming
@@ -44,14 +53,37 @@ namespace Analysis {
 
             rpm::vector<double> ar;
             double S;
+
+            rpm::vector<int> back; // best predecessor of each candidate
         };
 
         LP::Autocorr lpc;
         int lpcOrder;
-        int nbFrames;
 
     private:
+        double transitionCost(const Cand& ck, const Cand& cj, double rr, double S) const;
+        void decodeFrame(Frame& frm);
+
+        void decimate(const double *data, int length, double mu, int factor, rpm::vector<double>& dss);
+
+        // Fixed-lag Viterbi state: the last lookahead + 1 frames, and the
+        // accumulated cost of each candidate of the newest one.
         rpm::deque<Frame> frames;
+        rpm::vector<double> D;
+        rpm::vector<double> Dnext;
+
+        // Linear-phase lowpass decimator to Fds, evaluated only at the outputs the
+        // downsampled NCCF reads. The previous frame supplies the samples its
+        // taps need before the start of a frame that continues it.
+        int decimatorFactor;
+        rpm::vector<double> decimatorKernel;
+        int nextHop;
+        int lastLength;
+        rpm::vector<double> lastFrame;
+        rpm::vector<double> dsBuffer;
+
+        NCCF nccfDownsampled;
+        NCCF nccfOriginal;
     };
 }
 
@@ -0,0 +1,123 @@
+#include "pitch.h"
+#include <algorithm>
+#include <cmath>
+
+using Analysis::PitchResult;
+using namespace Analysis::Pitch;
+
+StreamingYin::StreamingYin(double threshold, double minPitch, double maxPitch)
+    : mThreshold(threshold),
+      mMinPitch(minPitch),
+      mMaxPitch(maxPitch),
+      mFFT(nullptr)
+{
+}
+
+PitchResult StreamingYin::solve(const double *data, int length, int sampleRate)
+{
+    const int tauMin = std::max<int>(2, std::floor(sampleRate / mMaxPitch));
+    const int tauMax = std::min<int>(std::ceil(sampleRate / mMinPitch), length / 2);
+
+    if (tauMax <= tauMin + 1) {
+        return {.pitch = 0.0, .voiced = false};
+    }
+
+    // Integration window, every lag up to tauMax stays inside the frame.
+    const int window = length - tauMax;
+
+    const int nfft = nextFastLength(length);
+
+    if (!mFFT || (int) mFFT->getInputLength() != nfft) {
+        mFFT = std::make_unique<RealFFT>(nfft);
+        mSpectrum.resize(mFFT->getOutputLength());
+    }
+
+    const int nout = mFFT->getOutputLength();
+
+    // Cross-correlation of the first window with the whole frame:
+    // r(tau) = sum_{j < W} x[j] x[j + tau], no circular aliasing for nfft >= length.
+    for (int i = 0; i < window; ++i) {
+        mFFT->input(i) = data[i];
+    }
+    for (int i = window; i < nfft; ++i) {
+        mFFT->input(i) = 0.0;
+    }
+    mFFT->computeForward();
+    for (int k = 0; k < nout; ++k) {
+        mSpectrum[k] = std::conj(mFFT->output(k));
+    }
+
+    for (int i = 0; i < length; ++i) {
+        mFFT->input(i) = data[i];
+    }
+    for (int i = length; i < nfft; ++i) {
+        mFFT->input(i) = 0.0;
+    }
+    mFFT->computeForward();
+    for (int k = 0; k < nout; ++k) {
+        mFFT->output(k) *= mSpectrum[k];
+    }
+    mFFT->computeBackward();
+
+    mCorrelation.resize(tauMax + 1);
+    for (int tau = 0; tau <= tauMax; ++tau) {
+        mCorrelation(tau) = mFFT->input(tau) / nfft;
+    }
+
+    // Energy of the window shifted by tau, as a running sum.
+    mEnergy.resize(tauMax + 1);
+    double energy = 0.0;
+    for (int j = 0; j < window; ++j) {
+        energy += data[j] * data[j];
+    }
+    mEnergy(0) = energy;
+    for (int tau = 1; tau <= tauMax; ++tau) {
+        energy += data[tau + window - 1] * data[tau + window - 1] - data[tau - 1] * data[tau - 1];
+        mEnergy(tau) = std::max(energy, 0.0);
+    }
+
+    if (mEnergy(0) < 1e-10) {
+        return {.pitch = 0.0, .voiced = false};
+    }
+
+    mDifference = (mEnergy(0) + mEnergy - 2 * mCorrelation).max(0.0);
+
+    mCumulative.resize(tauMax + 1);
+    double runningSum = 0.0;
+    mCumulative(0) = 1.0;
+    for (int tau = 1; tau <= tauMax; ++tau) {
+        runningSum += mDifference(tau);
+        mCumulative(tau) = runningSum;
+    }
+
+    mCMND.resize(tauMax + 1);
+    mCMND(0) = 1.0;
+    mCMND.tail(tauMax) = mDifference.tail(tauMax)
+                            * Eigen::ArrayXd::LinSpaced(tauMax, 1, tauMax)
+                            / mCumulative.tail(tauMax).max(1e-300);
+
+    int k;
+    for (k = tauMin; k < tauMax; ++k) {
+        if (mCMND(k) < mThreshold) {
+            while (k + 1 < tauMax && mCMND(k + 1) < mCMND(k))
+                k++;
+            break;
+        }
+    }
+
+    if (k >= tauMax) {
+        return {.pitch = 0.0, .voiced = false};
+    }
+
+    // Parabolic interpolation around the dip.
+    double tau = k;
+    const double a = mCMND(k - 1);
+    const double b = mCMND(k);
+    const double c = mCMND(k + 1);
+    const double denom = a - 2 * b + c;
+    if (denom > 0) {
+        tau += std::clamp(0.5 * (a - c) / denom, -0.5, 0.5);
+    }
+
+    return {.pitch = sampleRate / tau, .voiced = true};
+}
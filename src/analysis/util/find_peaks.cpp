@@ -53,7 +53,7 @@ static void signVector(rpm::vector<double> in, rpm::vector<int>& out, int sign)
     }
 }
 
-rpm::vector<int> Analysis::findPeaks(const double *data, int length, int sign)
+rpm::vector<int> Analysis::findPeaks(const double *data, int length, int sign, double selectivity)
 {
     rpm::vector<double> x0(data, std::next(data, length));
     rpm::vector<int> peakInds;
@@ -61,7 +61,7 @@ rpm::vector<int> Analysis::findPeaks(const double *data, int length, int sign)
     int minIdx = distance(x0.begin(), min_element(x0.begin(), x0.end()));
     int maxIdx = distance(x0.begin(), max_element(x0.begin(), x0.end()));
 
-    double sel = (x0[maxIdx]-x0[minIdx])/4.0;
+    double sel = selectivity >= 0 ? selectivity : (x0[maxIdx]-x0[minIdx])/4.0;
 
     int len0 = x0.size();
 
@@ -1,10 +1,34 @@
 #include "util.h"
 #include "laguerre.h"
+#include "fixed_roots.h"
 #include <iostream>
+#include <utility>
+
+// Orders for which a solver is specialised at compile time.
+static constexpr int kMinFixedDegree = 8;
+static constexpr int kMaxFixedDegree = 24;
+
+using FixedSolver = void (*)(const double *, std::complex<double> *);
+
+template<int... Ds>
+static constexpr std::array<FixedSolver, sizeof...(Ds)> makeFixedSolvers(std::integer_sequence<int, Ds...>)
+{
+    return { &Analysis::laguerreSolveFixed<Ds + kMinFixedDegree>... };
+}
+
+static constexpr auto sFixedSolvers =
+        makeFixedSolvers(std::make_integer_sequence<int, kMaxFixedDegree - kMinFixedDegree + 1>());
 
 rpm::vector<std::complex<double>> Analysis::findRoots(const rpm::vector<double>& p)
 {
+    const int degree = p.size() - 1;
+
+    if (degree >= kMinFixedDegree && degree <= kMaxFixedDegree && p[0] != 0.0) {
+        std::array<std::complex<double>, kMaxFixedDegree> roots;
+        sFixedSolvers[degree - kMinFixedDegree](p.data(), roots.data());
+        return rpm::vector<std::complex<double>>(roots.begin(), roots.begin() + degree);
+    }
+
     auto roots = Analysis::laguerreSolve(p);
     return roots;
 }
-
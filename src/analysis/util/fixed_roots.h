@@ -0,0 +1,158 @@
+#ifndef ANALYSIS_FIXED_ROOTS_H
+#define ANALYSIS_FIXED_ROOTS_H
+
+#include <Eigen/Dense>
+#include <array>
+#include <complex>
+
+namespace Analysis {
+
+    /*
+     *  Root solvers specialised on the polynomial degree, for the orders used by
+     *  linear prediction. All storage is on the stack.
+     *
+     *  p holds the N + 1 coefficients in descending powers, p[0] being the
+     *  leading one, as passed to findRoots().
+     */
+
+    namespace FixedRoots {
+        // Value, first and second derivative at z of the real polynomial a (ascending, degree n),
+        // with the complex products written out: this is where the solvers spend their time.
+        inline void evaluate(const double *a, int n, const std::complex<double>& z,
+                             std::complex<double>& y, std::complex<double>& dy, std::complex<double>& d2y)
+        {
+            const double zr = z.real(), zi = z.imag();
+            double yr = a[n], yi = 0.0;
+            double dr = 0.0, di = 0.0;
+            double d2r = 0.0, d2i = 0.0;
+            for (int i = n - 1; i >= 0; --i) {
+                const double t2r = d2r * zr - d2i * zi + dr;
+                d2i = d2r * zi + d2i * zr + di;
+                d2r = t2r;
+                const double tdr = dr * zr - di * zi + yr;
+                di = dr * zi + di * zr + yi;
+                dr = tdr;
+                const double tyr = yr * zr - yi * zi + a[i];
+                yi = yr * zi + yi * zr;
+                yr = tyr;
+            }
+            y = { yr, yi };
+            dy = { dr, di };
+            d2y = { 2.0 * d2r, 2.0 * d2i };
+        }
+
+        inline std::complex<double> laguerre(const double *a, int n, std::complex<double> z, double accuracy, int maxIt)
+        {
+            const double accuracy2 = accuracy * accuracy;
+
+            for (int it = 0; it < maxIt; ++it) {
+                std::complex<double> y, dy, d2y;
+                evaluate(a, n, z, y, dy, d2y);
+
+                if (std::norm(y) < accuracy2)
+                    return z;
+
+                const auto g = dy / y;
+                const auto h = g * g - d2y / y;
+                const auto f = std::sqrt(((double) n - 1) * ((double) n * h - g * g));
+
+                const auto dx = (std::norm(g + f) > std::norm(g - f))
+                                    ? (double) n / (g + f)
+                                    : (double) n / (g - f);
+
+                // A fractional step every few iterations breaks limit cycles.
+                constexpr double frac[] = { 0.5, 0.25, 0.75, 0.13, 0.38, 0.62, 0.88, 1.0 };
+                if ((it + 1) % 10 != 0)
+                    z -= dx;
+                else
+                    z -= frac[((it + 1) / 10 - 1) % 8] * dx;
+
+                if (std::norm(dx) < accuracy2)
+                    return z;
+            }
+            return z;
+        }
+    }
+
+    /*
+     *  Laguerre's method with deflation, each root then polished against the full
+     *  polynomial. Complex roots are taken with their conjugate and deflated as a
+     *  real quadratic factor, so the polynomial stays real and only one root of
+     *  each pair is searched for and polished.
+     */
+    template<int N>
+    void laguerreSolveFixed(const double *p, std::complex<double> *roots)
+    {
+        std::array<double, N + 1> a, d;
+        for (int i = 0; i <= N; ++i)
+            a[i] = d[i] = p[N - i];
+
+        int count = 0;
+        std::array<bool, N> paired;
+
+        for (int n = N; n >= 1; ) {
+            // Converged tightly before telling real roots from conjugate pairs.
+            auto z = FixedRoots::laguerre(d.data(), n, 0.0, 1e-6, 5000);
+            z = FixedRoots::laguerre(d.data(), n, z, 1e-12, 50);
+
+            if (n >= 2 && std::abs(z.imag()) > 1e-8 * std::abs(z)) {
+                // Division by x^2 - 2 Re(z) x + |z|^2.
+                const double b1 = -2.0 * z.real();
+                const double b0 = std::norm(z);
+                std::array<double, N + 1> q;
+                q[n - 2] = d[n];
+                if (n >= 3)
+                    q[n - 3] = d[n - 1] - b1 * q[n - 2];
+                for (int i = n - 4; i >= 0; --i)
+                    q[i] = d[i + 2] - b1 * q[i + 1] - b0 * q[i + 2];
+                std::copy(q.begin(), q.begin() + n - 1, d.begin());
+
+                paired[count] = true;
+                roots[count++] = z;
+                paired[count] = false;
+                roots[count++] = std::conj(z);
+                n -= 2;
+            }
+            else {
+                z.imag(0.0);
+                double carry = d[n];
+                for (int i = n - 1; i >= 0; --i) {
+                    const double next = d[i];
+                    d[i] = carry;
+                    carry = next + z.real() * carry;
+                }
+
+                paired[count] = false;
+                roots[count++] = z;
+                n -= 1;
+            }
+        }
+
+        for (int i = 0; i < N; ++i) {
+            roots[i] = FixedRoots::laguerre(a.data(), N, roots[i], 1e-12, 5000);
+            if (paired[i]) {
+                roots[i + 1] = std::conj(roots[i]);
+                ++i;
+            }
+        }
+    }
+
+    // Eigenvalues of the companion matrix, through Eigen's fixed-size real Schur decomposition.
+    template<int N>
+    void companionSolveFixed(const double *p, std::complex<double> *roots)
+    {
+        Eigen::Matrix<double, N, N> C = Eigen::Matrix<double, N, N>::Zero();
+        for (int j = 0; j < N; ++j)
+            C(0, j) = -p[j + 1] / p[0];
+        for (int i = 1; i < N; ++i)
+            C(i, i - 1) = 1.0;
+
+        Eigen::EigenSolver<Eigen::Matrix<double, N, N>> solver(C, false);
+        const auto& values = solver.eigenvalues();
+        for (int i = 0; i < N; ++i)
+            roots[i] = values(i);
+    }
+
+}
+
+#endif // ANALYSIS_FIXED_ROOTS_H
@@ -0,0 +1,47 @@
+#include "parallel.h"
+#include "rpcxx.h"
+#include <algorithm>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+void Analysis::parallelFor(int count, const std::function<void(int, int)>& body)
+{
+    if (count <= 0) {
+        return;
+    }
+
+    const int threads = std::clamp<int>(std::thread::hardware_concurrency(), 1, count);
+    const int chunk = (count + threads - 1) / threads;
+
+    std::exception_ptr error;
+    std::mutex errorMutex;
+
+    auto run = [&](int begin, int end) {
+        try {
+            body(begin, end);
+        }
+        catch (...) {
+            std::lock_guard<std::mutex> lock(errorMutex);
+            if (!error) {
+                error = std::current_exception();
+            }
+        }
+    };
+
+    rpm::vector<std::thread> workers;
+    int begin = 0;
+    while (begin + chunk < count) {
+        workers.emplace_back(run, begin, begin + chunk);
+        begin += chunk;
+    }
+    run(begin, count);
+
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
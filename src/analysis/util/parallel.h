@@ -0,0 +1,14 @@
+#ifndef ANALYSIS_PARALLEL_H
+#define ANALYSIS_PARALLEL_H
+
+#include <functional>
+
+namespace Analysis {
+
+    // Splits [0, count) into one contiguous range per hardware thread and runs body(begin, end)
+    // on each, the last range on the calling thread. Rethrows the first exception of any range.
+    void parallelFor(int count, const std::function<void(int, int)>& body);
+
+}
+
+#endif // ANALYSIS_PARALLEL_H
@@ -0,0 +1,232 @@
+#include "root_tracker.h"
+#include "util.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace Analysis;
+
+static constexpr int kMaxIterations = 8;
+static constexpr double kStepTolerance = 1e-12;
+static constexpr double kBackwardTolerance = 1e-10;
+static constexpr double kSeparationTolerance = 1e-7;
+
+RootTracker::RootTracker()
+    : mDegree(0),
+      mFallbacks(0)
+{
+}
+
+rpm::vector<std::complex<double>> RootTracker::solve(const rpm::vector<double>& p)
+{
+    const int degree = p.size() - 1;
+
+    if (degree < 1 || p[0] == 0.0) {
+        mRoots.clear();
+        return findRoots(p);
+    }
+
+    if (mDegree != degree || mRoots.empty() || !refine(p)) {
+        mDegree = degree;
+        mRoots.clear();
+        mFallbacks++;
+
+        const auto roots = findRoots(p);
+
+        // One representative per conjugate pair, real roots made exactly real.
+        int count = 0;
+        for (const auto& z : roots) {
+            if (std::abs(z.imag()) <= kSeparationTolerance * std::max(1.0, std::abs(z))) {
+                mRoots.emplace_back(z.real(), 0.0);
+                count++;
+            }
+            else if (z.imag() > 0.0) {
+                mRoots.push_back(z);
+                count += 2;
+            }
+        }
+        if (count != degree) {
+            mRoots.clear();
+            return roots;
+        }
+    }
+
+    rpm::vector<std::complex<double>> roots;
+    roots.reserve(degree);
+    for (const auto& z : mRoots) {
+        roots.push_back(z);
+        if (z.imag() != 0.0)
+            roots.push_back(std::conj(z));
+    }
+    return roots;
+}
+
+void RootTracker::reset()
+{
+    mRoots.clear();
+}
+
+int RootTracker::getFallbackCount() const
+{
+    return mFallbacks;
+}
+
+bool RootTracker::refine(const rpm::vector<double>& p)
+{
+    if (!iterate(p)) {
+        restructure();
+        if (!iterate(p))
+            return false;
+    }
+
+    const int n = p.size() - 1;
+    const int m = mRoots.size();
+    const auto& z = mRoots;
+
+    // Restructuring two coinciding real roots leaves a pair on the real axis, one root short.
+    int count = 0;
+    for (int k = 0; k < m; ++k)
+        count += z[k].imag() != 0.0 ? 2 : 1;
+    if (count != n)
+        return false;
+
+    for (int k = 0; k < m; ++k) {
+        // Backward error: residual relative to the size of the terms that make it up.
+        const double r = std::abs(z[k]);
+        std::complex<double> y = p[0];
+        double scale = std::abs(p[0]);
+        for (int i = 1; i <= n; ++i) {
+            y = y * z[k] + p[i];
+            scale = scale * r + std::abs(p[i]);
+        }
+        // Written so that a NaN fails, std::isfinite is compiled out under -ffast-math.
+        if (!(std::abs(y) <= kBackwardTolerance * scale))
+            return false;
+
+        // Distinct from every other root, including its own conjugate.
+        const double tolerance = kSeparationTolerance * std::max(1.0, r);
+        if (z[k].imag() != 0.0 && !(2.0 * std::abs(z[k].imag()) >= tolerance))
+            return false;
+        for (int j = 0; j < k; ++j) {
+            if (!(std::abs(z[k] - z[j]) >= tolerance) || !(std::abs(z[k] - std::conj(z[j])) >= tolerance))
+                return false;
+        }
+    }
+
+    return true;
+}
+
+bool RootTracker::iterate(const rpm::vector<double>& p)
+{
+    const int n = p.size() - 1;
+    const int m = mRoots.size();
+    auto& z = mRoots;
+
+    // Aberth-Ehrlich on the conjugate-symmetric root set, updated in place.
+    // The complex arithmetic is written out, this loop is O(n^2) per iteration.
+    double maxStep = HUGE_VAL;
+    for (int it = 0; it < kMaxIterations && maxStep > kStepTolerance; ++it) {
+        maxStep = 0.0;
+        for (int k = 0; k < m; ++k) {
+            const double zr = z[k].real(), zi = z[k].imag();
+
+            double yr = p[0], yi = 0.0, dr = 0.0, di = 0.0;
+            for (int i = 1; i <= n; ++i) {
+                const double tdr = dr * zr - di * zi + yr;
+                di = dr * zi + di * zr + yi;
+                dr = tdr;
+                const double tyr = yr * zr - yi * zi + p[i];
+                yi = yr * zi + yi * zr;
+                yr = tyr;
+            }
+            if (yr == 0.0 && yi == 0.0)
+                continue;
+
+            // Sum of 1 / (z - zj) over all other roots, conjugates included.
+            // Coinciding roots would divide by zero; the NaN that follows is not
+            // reliably caught under -ffast-math, so give up on them here.
+            double sr = 0.0, si = 0.0;
+            bool coincident = false;
+            auto addRepulsion = [&](double ar, double ai) {
+                const double ur = zr - ar, ui = zi - ai;
+                const double d = ur * ur + ui * ui;
+                if (d == 0.0) {
+                    coincident = true;
+                    return;
+                }
+                const double inv = 1.0 / d;
+                sr += ur * inv;
+                si -= ui * inv;
+            };
+            for (int j = 0; j < m; ++j) {
+                const double ar = z[j].real(), ai = z[j].imag();
+                if (j != k)
+                    addRepulsion(ar, ai);
+                if (ai != 0.0 && (j != k || zi != 0.0))
+                    addRepulsion(ar, -ai);
+            }
+            if (coincident)
+                return false;
+
+            // ratio = y / y', step = ratio / (1 - ratio * s)
+            const double dd = dr * dr + di * di;
+            if (dd == 0.0)
+                return false;
+            const double dn = 1.0 / dd;
+            const double qr = (yr * dr + yi * di) * dn;
+            const double qi = (yi * dr - yr * di) * dn;
+            const double br = 1.0 - (qr * sr - qi * si);
+            const double bi = -(qr * si + qi * sr);
+            const double bd = br * br + bi * bi;
+            if (bd == 0.0)
+                return false;
+            const double bn = 1.0 / bd;
+            const double stepr = (qr * br + qi * bi) * bn;
+            const double stepi = (qi * br - qr * bi) * bn;
+
+            // Real roots stay on the real axis.
+            z[k] = { zr - stepr, zi != 0.0 ? zi - stepi : 0.0 };
+
+            maxStep = std::max(maxStep, std::hypot(stepr, stepi) / std::max(1.0, std::abs(z[k])));
+        }
+    }
+
+    return maxStep <= kStepTolerance;
+}
+
+void RootTracker::restructure()
+{
+    auto& z = mRoots;
+    const int m = z.size();
+
+    // The complex root closest to the real axis, and the two closest real roots.
+    int complexIndex = -1;
+    for (int k = 0; k < m; ++k) {
+        if (z[k].imag() != 0.0 && (complexIndex < 0 || z[k].imag() < z[complexIndex].imag()))
+            complexIndex = k;
+    }
+
+    int realA = -1, realB = -1;
+    for (int k = 0; k < m; ++k) {
+        for (int j = 0; j < k; ++j) {
+            if (z[k].imag() == 0.0 && z[j].imag() == 0.0
+                    && (realA < 0 || std::abs(z[k].real() - z[j].real()) < std::abs(z[realA].real() - z[realB].real()))) {
+                realA = j;
+                realB = k;
+            }
+        }
+    }
+
+    const double splitDistance = complexIndex >= 0 ? z[complexIndex].imag() : HUGE_VAL;
+    const double mergeDistance = realA >= 0 ? 0.5 * std::abs(z[realA].real() - z[realB].real()) : HUGE_VAL;
+
+    if (splitDistance < mergeDistance) {
+        const auto w = z[complexIndex];
+        z[complexIndex] = { w.real() - w.imag(), 0.0 };
+        z.emplace_back(w.real() + w.imag(), 0.0);
+    }
+    else if (realA >= 0) {
+        const double centre = 0.5 * (z[realA].real() + z[realB].real());
+        z[realA] = { centre, mergeDistance };
+        z.erase(z.begin() + realB);
+    }
+}
@@ -0,0 +1,46 @@
+#ifndef ANALYSIS_ROOT_TRACKER_H
+#define ANALYSIS_ROOT_TRACKER_H
+
+#include "rpcxx.h"
+#include <complex>
+
+namespace Analysis {
+
+    /*
+     *  Roots of a polynomial that changes slowly from one call to the next, such
+     *  as the LPC polynomials of consecutive frames.
+     *
+     *  The previous roots seed a few Aberth-Ehrlich iterations, which refine all
+     *  roots at once and keep them apart. The result is accepted only if every
+     *  root has converged to a negligible backward error and all of them are
+     *  distinct: N distinct roots of a degree N polynomial are then the whole
+     *  set. Otherwise, or when the degree changed, findRoots() is called.
+     */
+    class RootTracker {
+    public:
+        RootTracker();
+
+        // p holds the coefficients in descending powers, as for findRoots().
+        rpm::vector<std::complex<double>> solve(const rpm::vector<double>& p);
+
+        void reset();
+
+        // Number of solves that had to fall back to findRoots(), for diagnostics.
+        int getFallbackCount() const;
+
+    private:
+        bool refine(const rpm::vector<double>& p);
+        bool iterate(const rpm::vector<double>& p);
+        // Turns the complex pair closest to the real axis into two real roots, or
+        // the two closest real roots into a complex pair, whichever is nearer.
+        void restructure();
+
+        // One root of each conjugate pair, and the real roots.
+        rpm::vector<std::complex<double>> mRoots;
+        int mDegree;
+        int mFallbacks;
+    };
+
+}
+
+#endif // ANALYSIS_ROOT_TRACKER_H
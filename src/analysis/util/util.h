@@ -9,7 +9,8 @@
 
 namespace Analysis {
 
-    rpm::vector<int> findPeaks(const double *data, int length, int sign = +1);
+    // A negative selectivity uses a quarter of the data range.
+    rpm::vector<int> findPeaks(const double *data, int length, int sign = +1, double selectivity = -1);
 
     std::pair<rpm::vector<double>, rpm::vector<double>> findZerocros(const rpm::vector<double>& y, char m);
 
@@ -0,0 +1,138 @@
+#include "vad.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace Analysis;
+
+static constexpr double noiseFloorRise = 0.02;
+// About half a second at a 10 ms hop.
+static constexpr int noiseFloorLearningFrames = 50;
+
+VoiceActivityDetector::VoiceActivityDetector()
+    : mEnergyThreshold(8.0),
+      mMinimumEnergy(-65.0),
+      mZeroCrossingThreshold(0.3),
+      mFlatnessThreshold(0.5),
+      mHangover(15)
+{
+    reset();
+}
+
+void VoiceActivityDetector::setEnergyThreshold(double dB)
+{
+    mEnergyThreshold = dB;
+}
+
+void VoiceActivityDetector::setMinimumEnergy(double dB)
+{
+    mMinimumEnergy = dB;
+}
+
+void VoiceActivityDetector::setZeroCrossingThreshold(double rate)
+{
+    mZeroCrossingThreshold = rate;
+}
+
+void VoiceActivityDetector::setFlatnessThreshold(double flatness)
+{
+    mFlatnessThreshold = flatness;
+}
+
+void VoiceActivityDetector::setHangover(int frames)
+{
+    mHangover = frames;
+}
+
+void VoiceActivityDetector::reset()
+{
+    mNoiseFloorFrames = 0;
+    mNoiseFloor = 0.0;
+    mHangoverCount = 0;
+}
+
+VoiceActivityResult VoiceActivityDetector::process(const double *x, int length)
+{
+    VoiceActivityResult result;
+
+    double sumSq = 0.0;
+    int crossings = 0;
+    for (int i = 0; i < length; ++i) {
+        sumSq += x[i] * x[i];
+        if (i > 0 && std::signbit(x[i]) != std::signbit(x[i - 1])) {
+            crossings++;
+        }
+    }
+    result.energy = 10.0 * log10(sumSq / length + 1e-12);
+    result.zeroCrossingRate = (double) crossings / std::max(1, length - 1);
+
+    int nfft = 1;
+    while (nfft < length) {
+        nfft <<= 1;
+    }
+    if (!mFFT || (int) mFFT->getInputLength() != nfft) {
+        mFFT = std::make_unique<RealFFT>(nfft);
+    }
+    if ((int) mWindow.size() != length) {
+        mWindow.resize(length);
+        for (int i = 0; i < length; ++i) {
+            mWindow[i] = 0.5 - 0.5 * cos((2.0 * M_PI * i) / (length - 1));
+        }
+    }
+
+    for (int i = 0; i < length; ++i) {
+        mFFT->input(i) = mWindow[i] * x[i];
+    }
+    for (int i = length; i < nfft; ++i) {
+        mFFT->input(i) = 0.0;
+    }
+    mFFT->computeForward();
+
+    // Geometric over arithmetic mean of the power spectrum, DC excluded.
+    double logSum = 0.0;
+    double sum = 0.0;
+    const int nbins = mFFT->getOutputLength();
+    for (int k = 1; k < nbins; ++k) {
+        const double power = std::norm(mFFT->output(k)) + 1e-20;
+        logSum += log(power);
+        sum += power;
+    }
+    result.spectralFlatness = exp(logSum / (nbins - 1)) / (sum / (nbins - 1));
+
+    // The noise floor follows drops immediately. The first frame seeds it,
+    // a NaN sentinel would not survive -ffast-math.
+    if (mNoiseFloorFrames == 0 || result.energy < mNoiseFloor) {
+        mNoiseFloor = result.energy;
+    }
+    const bool learning = mNoiseFloorFrames < noiseFloorLearningFrames;
+    if (learning) {
+        mNoiseFloorFrames++;
+    }
+
+    const bool loud = result.energy > std::max(mNoiseFloor + mEnergyThreshold, mMinimumEnergy);
+    const bool noiseLike = result.spectralFlatness > mFlatnessThreshold
+                            && result.zeroCrossingRate > mZeroCrossingThreshold;
+
+    // It only rises towards frames that are not speech, with a time constant
+    // of about half a second at a 10 ms hop.
+    if (!loud || noiseLike) {
+        mNoiseFloor += noiseFloorRise * (result.energy - mNoiseFloor);
+    }
+
+    if (loud && !noiseLike) {
+        result.active = true;
+        mHangoverCount = mHangover;
+    }
+    else if (mHangoverCount > 0) {
+        result.active = true;
+        mHangoverCount--;
+    }
+    else if (learning) {
+        // Until then the floor is only the quietest frame so far, which may be speech.
+        result.active = result.energy > mMinimumEnergy && !noiseLike;
+    }
+    else {
+        result.active = false;
+    }
+
+    return result;
+}
@@ -0,0 +1,59 @@
+#ifndef ANALYSIS_VAD_H
+#define ANALYSIS_VAD_H
+
+#include "rpcxx.h"
+#include "../fft/fft.h"
+#include <memory>
+
+namespace Analysis {
+
+    struct VoiceActivityResult {
+        bool active;
+        double energy;              // dBFS
+        double zeroCrossingRate;    // crossings per sample
+        double spectralFlatness;    // 0 (tonal) to 1 (white)
+    };
+
+    /*
+     *  Cheap frame-level voice activity detector.
+     *
+     *  A frame is active when its energy is far enough above an adaptive noise
+     *  floor and it does not look like noise (both flat and with a high
+     *  zero-crossing rate). Decisions are held for a few frames after the last
+     *  active one so that word endings are not cut off.
+     *
+     *  While the noise floor is still being learned, every frame above the
+     *  minimum energy that does not look like noise is active, so that a
+     *  stream which starts in speech is not gated against its own level.
+     */
+    class VoiceActivityDetector {
+    public:
+        VoiceActivityDetector();
+
+        void setEnergyThreshold(double dB);
+        void setMinimumEnergy(double dB);
+        void setZeroCrossingThreshold(double rate);
+        void setFlatnessThreshold(double flatness);
+        void setHangover(int frames);
+
+        VoiceActivityResult process(const double *x, int length);
+        void reset();
+
+    private:
+        double mEnergyThreshold;
+        double mMinimumEnergy;
+        double mZeroCrossingThreshold;
+        double mFlatnessThreshold;
+        int mHangover;
+
+        int mNoiseFloorFrames;
+        double mNoiseFloor;
+        int mHangoverCount;
+
+        std::unique_ptr<RealFFT> mFFT;
+        rpm::vector<double> mWindow;
+    };
+
+}
+
+#endif // ANALYSIS_VAD_H
@@ -374,11 +374,102 @@ int Config::getAnalysisLpOffset()
     return integerField(mTbl["analysis"], "lpOffset", +1);
 }
 
+LinpredOrderSelection Config::getAnalysisLpOrderSelection()
+{
+    return enumField(mTbl["analysis"], "lpOrderSelection", LinpredOrderSelection::Fixed);
+}
+
+void Config::setAnalysisLpOrderSelection(LinpredOrderSelection selection)
+{
+    mTbl["analysis"]["lpOrderSelection"].ref<int64_t>() = enumInt(selection);
+    emit lpOrderSelectionChanged(enumInt(selection));
+}
+
+int Config::getAnalysisLpOrderSelectionNumeric()
+{
+    return enumInt(getAnalysisLpOrderSelection());
+}
+
+void Config::setAnalysisLpOrderSelection(int selection)
+{
+    setAnalysisLpOrderSelection(static_cast<LinpredOrderSelection>(selection));
+}
+
+int Config::getAnalysisDeepFormantsThreads()
+{
+    return integerField(mTbl["analysis"], "deepFormantsThreads", 0);
+}
+
 int Config::getAnalysisPitchSampleRate()
 {
     return integerField(mTbl["analysis"], "pitchSampleRate", 32000);
 }
 
+double Config::getAnalysisPitchFrameLength()
+{
+    return doubleField(mTbl["analysis"], "pitchFrameLength", 40.0);
+}
+
+double Config::getAnalysisPitchFrameHop()
+{
+    return doubleField(mTbl["analysis"], "pitchFrameHop", 20.0);
+}
+
+int Config::getAnalysisPitchLookahead()
+{
+    return integerField(mTbl["analysis"], "pitchLookahead", 5);
+}
+
+double Config::getAnalysisFormantFrameLength()
+{
+    return doubleField(mTbl["analysis"], "formantFrameLength", 20.0);
+}
+
+double Config::getAnalysisFormantFrameHop()
+{
+    return doubleField(mTbl["analysis"], "formantFrameHop", 10.0);
+}
+
+double Config::getAnalysisSpectrogramFrameLength()
+{
+    return doubleField(mTbl["analysis"], "spectrogramFrameLength", 50.0);
+}
+
+double Config::getAnalysisSpectrogramFrameHop()
+{
+    return doubleField(mTbl["analysis"], "spectrogramFrameHop", 12.5);
+}
+
+bool Config::getAnalysisVadEnabled()
+{
+    return boolField(mTbl["analysis"], "vadEnabled", true);
+}
+
+double Config::getAnalysisVadEnergyThreshold()
+{
+    return doubleField(mTbl["analysis"], "vadEnergyThreshold", 8.0);
+}
+
+double Config::getAnalysisVadMinimumEnergy()
+{
+    return doubleField(mTbl["analysis"], "vadMinimumEnergy", -65.0);
+}
+
+double Config::getAnalysisVadZeroCrossingThreshold()
+{
+    return doubleField(mTbl["analysis"], "vadZeroCrossingThreshold", 0.3);
+}
+
+double Config::getAnalysisVadFlatnessThreshold()
+{
+    return doubleField(mTbl["analysis"], "vadFlatnessThreshold", 0.5);
+}
+
+double Config::getAnalysisVadHangover()
+{
+    return doubleField(mTbl["analysis"], "vadHangover", 150.0);
+}
+
 bool Config::isPaused()
 {
     return mPaused;
@@ -21,6 +21,7 @@ namespace Main {
         Q_PROPERTY(int linpredAlgorithm     READ getLinpredAlgorithmNumeric     WRITE setLinpredAlgorithm       NOTIFY linpredAlgorithmChanged)
         Q_PROPERTY(int formantAlgorithm     READ getFormantAlgorithmNumeric     WRITE setFormantAlgorithm       NOTIFY formantAlgorithmChanged)
         Q_PROPERTY(int invglotAlgorithm     READ getInvglotAlgorithmNumeric     WRITE setInvglotAlgorithm       NOTIFY invglotAlgorithmChanged)
+        Q_PROPERTY(int lpOrderSelection     READ getAnalysisLpOrderSelectionNumeric WRITE setAnalysisLpOrderSelection NOTIFY lpOrderSelectionChanged)
         Q_PROPERTY(int viewMinFrequency     READ getViewMinFrequency            WRITE setViewMinFrequency       NOTIFY viewMinFrequencyChanged)
         Q_PROPERTY(int viewMaxFrequency     READ getViewMaxFrequency            WRITE setViewMaxFrequency       NOTIFY viewMaxFrequencyChanged)
         Q_PROPERTY(int viewFFTSize          READ getViewFFTSize                 WRITE setViewFFTSize            NOTIFY viewFFTSizeChanged)
@@ -37,6 +38,7 @@ namespace Main {
         void linpredAlgorithmChanged(int);
         void formantAlgorithmChanged(int);
         void invglotAlgorithmChanged(int);
+        void lpOrderSelectionChanged(int);
         void audioBackendChanged(int);
         void viewMinFrequencyChanged(int);
         void viewMaxFrequencyChanged(int);
@@ -115,8 +117,30 @@ namespace Main {
 
         int getAnalysisMaxFrequency();
         int getAnalysisLpOffset();
+        LinpredOrderSelection getAnalysisLpOrderSelection();
+        void setAnalysisLpOrderSelection(LinpredOrderSelection selection);
+
+        int getAnalysisLpOrderSelectionNumeric();
+        void setAnalysisLpOrderSelection(int selection);
+
+        int getAnalysisDeepFormantsThreads();
         int getAnalysisPitchSampleRate();
 
+        double getAnalysisPitchFrameLength();
+        double getAnalysisPitchFrameHop();
+        int getAnalysisPitchLookahead();
+        double getAnalysisFormantFrameLength();
+        double getAnalysisFormantFrameHop();
+        double getAnalysisSpectrogramFrameLength();
+        double getAnalysisSpectrogramFrameHop();
+
+        bool getAnalysisVadEnabled();
+        double getAnalysisVadEnergyThreshold();
+        double getAnalysisVadMinimumEnergy();
+        double getAnalysisVadZeroCrossingThreshold();
+        double getAnalysisVadFlatnessThreshold();
+        double getAnalysisVadHangover();
+
         // WILL NOT BE SERIALIZED
         bool isPaused();
         void setPaused(bool p);
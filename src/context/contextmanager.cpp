@@ -12,9 +12,9 @@ ContextManager::ContextManager(
                 int playbackSampleRate
             )
     : mConfig(std::make_unique<Config>()),
-      mPitchSolver(makePitchSolver(mConfig->getPitchAlgorithm())),
-      mLinpredSolver(makeLinpredSolver(mConfig->getLinpredAlgorithm())),
-      mFormantSolver(makeFormantSolver(mConfig->getFormantAlgorithm())),
+      mPitchSolver(makePitchSolver(mConfig->getPitchAlgorithm(), mConfig->getAnalysisPitchLookahead())),
+      mLinpredSolver(makeLinpredSolver(mConfig->getLinpredAlgorithm(), mConfig->getAnalysisLpOrderSelection())),
+      mFormantSolver(makeFormantSolver(mConfig->getFormantAlgorithm(), mConfig->getAnalysisDeepFormantsThreads())),
       mInvglotSolver(makeInvglotSolver(mConfig->getInvglotAlgorithm())),
       mCaptureBuffer(std::make_unique<Audio::Buffer>(captureSampleRate)),
       mPlaybackQueue(std::make_unique<Audio::Queue>(
@@ -44,19 +44,37 @@ ContextManager::ContextManager(
     mDataStore->setFormantTrackCount(4);
     QObject::connect(mConfig.get(), &Config::pitchAlgorithmChanged,
             [this](int index) {
-                mPitchSolver.reset(makePitchSolver(static_cast<PitchAlgorithm>(index)));
+                const int lookahead = mConfig->getAnalysisPitchLookahead();
+                mPitchSolver.request([index, lookahead] {
+                    return makePitchSolver(static_cast<PitchAlgorithm>(index), lookahead);
+                });
             });
     QObject::connect(mConfig.get(), &Config::linpredAlgorithmChanged,
             [this](int index) {
-                mLinpredSolver.reset(makeLinpredSolver(static_cast<LinpredAlgorithm>(index)));
+                const auto selection = mConfig->getAnalysisLpOrderSelection();
+                mLinpredSolver.request([index, selection] {
+                    return makeLinpredSolver(static_cast<LinpredAlgorithm>(index), selection);
+                });
+            });
+    QObject::connect(mConfig.get(), &Config::lpOrderSelectionChanged,
+            [this](int index) {
+                const auto alg = mConfig->getLinpredAlgorithm();
+                mLinpredSolver.request([alg, index] {
+                    return makeLinpredSolver(alg, static_cast<LinpredOrderSelection>(index));
+                });
             });
     QObject::connect(mConfig.get(), &Config::formantAlgorithmChanged,
             [this](int index) {
-                mFormantSolver.reset(makeFormantSolver(static_cast<FormantAlgorithm>(index)));
+                const int threads = mConfig->getAnalysisDeepFormantsThreads();
+                mFormantSolver.request([index, threads] {
+                    return makeFormantSolver(static_cast<FormantAlgorithm>(index), threads);
+                });
             });
     QObject::connect(mConfig.get(), &Config::invglotAlgorithmChanged,
             [this](int index) {
-                mInvglotSolver.reset(makeInvglotSolver(static_cast<InvglotAlgorithm>(index)));
+                mInvglotSolver.request([index] {
+                    return makeInvglotSolver(static_cast<InvglotAlgorithm>(index));
+                });
             });
     QObject::connect(mConfig.get(), &Config::audioBackendChanged,
             [this](int index) {
@@ -208,7 +226,9 @@ void ContextManager::synthesisThreadLoop()
 
     double maxFrequency = 0;
     rpm::vector<double> frequencies(1024);
-    rpm::vector<std::complex<double>> wn(frequencies.size());
+    rpm::vector<double> magnitudes(frequencies.size());
+    // Bins 1 .. N of a 2N-point grid span (0, fs/2] at any rate.
+    Analysis::FrequencyResponse response(2 * frequencies.size());
 
     double maxFrequencySource = 16000;
     Analysis::RealFFT fft(512);
@@ -265,11 +285,11 @@ void ContextManager::synthesisThreadLoop()
             maxFrequency = synthSampleRate / 2;
             for (int k = 0; k < frequencies.size(); ++k) {
                 frequencies[k] = maxFrequency * (double) (k + 1) / (double) frequencies.size();
-                wn[k] = std::polar(1.0, 2.0 * M_PI * frequencies[k] / synthSampleRate);
             }
         }
 
-        mSynthWrapper.setFilterResponse(frequencies, Analysis::sosfreqz(filter, wn));
+        response.sos(filter, 1, frequencies.size(), magnitudes.data());
+        mSynthWrapper.setFilterResponse(frequencies, magnitudes);
         
         auto source = mSynthesizer->getSourceCopy(maxFrequencySource * 2, 25.0);
         mSynthWrapper.setSource(source, maxFrequencySource * 2);
@@ -9,6 +9,7 @@
 #include "datastore.h"
 #include "views/views.h"
 #include "config.h"
+#include "solverslot.h"
 #include <atomic>
 #include <thread>
 
@@ -59,10 +60,10 @@ namespace Main {
 
         std::unique_ptr<Config> mConfig;
 
-        std::shared_ptr<Analysis::PitchSolver> mPitchSolver;
-        std::shared_ptr<Analysis::LinpredSolver> mLinpredSolver;
-        std::shared_ptr<Analysis::FormantSolver> mFormantSolver;
-        std::shared_ptr<Analysis::InvglotSolver> mInvglotSolver;
+        SolverSlot<Analysis::PitchSolver> mPitchSolver;
+        SolverSlot<Analysis::LinpredSolver> mLinpredSolver;
+        SolverSlot<Analysis::FormantSolver> mFormantSolver;
+        SolverSlot<Analysis::InvglotSolver> mInvglotSolver;
         
         std::unique_ptr<Audio::Buffer> mCaptureBuffer;
         std::unique_ptr<Audio::Queue> mPlaybackQueue;
@@ -2,10 +2,16 @@
 
 using namespace Main;
 
-DataStore::DataStore()
+DataStore::DataStore(int trackReserve)
     : mTrackLength(0),
+      mTrackReserve(trackReserve),
       mCatchupCount(1),
-      mTime(0)
+      mTime(0),
+      mSpectrogram(trackReserve),
+      mPitchTrack(trackReserve),
+      mSoundTrack(trackReserve),
+      mGifTrack(trackReserve),
+      mVoiceActivityTrack(trackReserve)
 {
 }
 
@@ -59,6 +65,11 @@ OptionalTimeTrack<double>& DataStore::getFormantTrack(int i)
     return mFormantTracks.at(i);
 }
 
+OptionalTimeTrack<double>& DataStore::getFormantBandwidthTrack(int i)
+{
+    return mFormantBandwidthTracks.at(i);
+}
+
 int DataStore::getFormantTrackCount() const
 {
     return mFormantTracks.size();
@@ -66,7 +77,15 @@ int DataStore::getFormantTrackCount() const
 
 void DataStore::setFormantTrackCount(int n)
 {
-    mFormantTracks.resize(n);
+    // Copies would not keep the reservation, so new tracks are built in place.
+    mFormantTracks.reserve(n);
+    mFormantBandwidthTracks.reserve(n);
+    while ((int) mFormantTracks.size() < n) {
+        mFormantTracks.emplace_back(mTrackReserve);
+        mFormantBandwidthTracks.emplace_back(mTrackReserve);
+    }
+    mFormantTracks.erase(mFormantTracks.begin() + n, mFormantTracks.end());
+    mFormantBandwidthTracks.erase(mFormantBandwidthTracks.begin() + n, mFormantBandwidthTracks.end());
 }
 
 TimeTrack<rpm::vector<double>>& DataStore::getSoundTrack()
@@ -79,4 +98,8 @@ TimeTrack<rpm::vector<double>>& DataStore::getGifTrack()
     return mGifTrack;
 }
 
+TimeTrack<bool>& DataStore::getVoiceActivityTrack()
+{
+    return mVoiceActivityTrack;
+}
 
@@ -25,7 +25,8 @@ namespace Main {
 
     class DataStore {
     public:
-        DataStore();
+        // Every track reserves room for trackReserve entries.
+        DataStore(int trackReserve = 1000000);
 
         void beginWrite();
         void endWrite();
@@ -41,14 +42,18 @@ namespace Main {
         OptionalTimeTrack<double>& getPitchTrack();
 
         OptionalTimeTrack<double>& getFormantTrack(int i);
+        OptionalTimeTrack<double>& getFormantBandwidthTrack(int i);
         int getFormantTrackCount() const;
         void setFormantTrackCount(int n);
 
         TimeTrack<rpm::vector<double>>& getSoundTrack();
         TimeTrack<rpm::vector<double>>& getGifTrack();
+
+        TimeTrack<bool>& getVoiceActivityTrack();
     
     private:
         int mTrackLength;
+        int mTrackReserve;
 
         std::shared_mutex mMutex;
         int mCatchupCount;
@@ -59,9 +64,12 @@ namespace Main {
         
         OptionalTimeTrack<double> mPitchTrack;
         rpm::vector<OptionalTimeTrack<double>> mFormantTracks;
+        rpm::vector<OptionalTimeTrack<double>> mFormantBandwidthTracks;
 
         TimeTrack<rpm::vector<double>> mSoundTrack;
         TimeTrack<rpm::vector<double>> mGifTrack;
+
+        TimeTrack<bool> mVoiceActivityTrack;
     };
 
 }
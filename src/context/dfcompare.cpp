@@ -0,0 +1,185 @@
+#include "dfcompare.h"
+#include "wavfile.h"
+#include "../analysis/analysis.h"
+#include "../analysis/formant/deepformants/df.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+
+using namespace Main;
+
+static constexpr double fsDF = 16000;
+static constexpr int numFormants = 4;
+
+// Frames more than 40 dB below the loudest one of their file are left out,
+// like the pipeline which only runs the formant solver on voiced audio.
+static constexpr double silenceThreshold = 1e-4;
+
+static rpm::vector<fs::path> collectFiles(const rpm::vector<std::string>& paths)
+{
+    rpm::vector<fs::path> files;
+    for (const auto& path : paths) {
+        if (fs::is_directory(path)) {
+            rpm::vector<fs::path> dir;
+            for (const auto& entry : fs::recursive_directory_iterator(path)) {
+                auto ext = entry.path().extension().string();
+                std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+                if (entry.is_regular_file() && ext == ".wav")
+                    dir.push_back(entry.path());
+            }
+            std::sort(dir.begin(), dir.end());
+            files.insert(files.end(), dir.begin(), dir.end());
+        }
+        else {
+            files.push_back(path);
+        }
+    }
+    return files;
+}
+
+// Same preparation as the pipeline: 100 Hz preemphasis and a Gaussian window.
+static void appendFrames(const rpm::vector<double>& x, int length, int hop, rpm::vector<double>& frames)
+{
+    const double preemphFactor = exp(-(2.0 * M_PI * 100) / fsDF);
+    const auto window = Analysis::gaussianWindow(length, 2.5);
+
+    rpm::vector<double> energies;
+    for (int start = 0; start + length <= (int) x.size(); start += hop) {
+        double e = 0;
+        for (int i = 0; i < length; ++i)
+            e += x[start + i] * x[start + i];
+        energies.push_back(e);
+    }
+    if (energies.empty())
+        return;
+
+    const double threshold = silenceThreshold * *std::max_element(energies.begin(), energies.end());
+
+    for (int f = 0; f < (int) energies.size(); ++f) {
+        if (energies[f] <= threshold)
+            continue;
+        const double *in = x.data() + f * hop;
+        frames.push_back(window[0] * in[0]);
+        for (int i = 1; i < length; ++i)
+            frames.push_back(window[i] * (in[i] - preemphFactor * in[i - 1]));
+    }
+}
+
+using Analysis::Formant::DenseNetwork;
+
+// Seconds per frame, one frame per call or all frames in one call.
+static double timeNetwork(DenseNetwork& network, const rpm::vector<float>& features, int count, bool batched,
+                          rpm::vector<float>& outputs)
+{
+    const int inputs = network.getInputLength();
+    const int stride = network.getOutputLength();
+    outputs.resize(count * stride);
+
+    const auto start = std::chrono::steady_clock::now();
+    if (batched) {
+        network.forward(features.data(), count, outputs.data());
+    }
+    else {
+        for (int i = 0; i < count; ++i)
+            network.forward(features.data() + i * inputs, 1, outputs.data() + i * stride);
+    }
+    const auto end = std::chrono::steady_clock::now();
+
+    return std::chrono::duration<double>(end - start).count() / count;
+}
+
+int Main::compareDeepFormants(Config *config, const rpm::vector<std::string>& paths)
+{
+    constexpr int numFeatures = Analysis::Formant::FeatureExtractor::numFeatures;
+
+    const int length = std::round(config->getAnalysisFormantFrameLength() / 1000.0 * fsDF);
+    const int hop = std::max<int>(1, std::round(config->getAnalysisFormantFrameHop() / 1000.0 * fsDF));
+
+    rpm::vector<double> frames;
+    int fileCount = 0;
+
+    for (const auto& path : collectFiles(paths)) {
+        rpm::vector<double> x;
+        int sampleRate;
+        if (!readWav(path, x, sampleRate)) {
+            std::cerr << "Skipping " << path.string() << ": not a supported WAV file" << std::endl;
+            continue;
+        }
+        if (sampleRate != (int) fsDF) {
+            Module::Audio::Resampler resampler(sampleRate, fsDF);
+            x = resampler.process(x.data(), x.size());
+        }
+        appendFrames(x, length, hop, frames);
+        fileCount++;
+    }
+
+    const int count = frames.size() / length;
+    if (count == 0) {
+        std::cerr << "No frames to analyse" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    // Both models see the same features, only the forward pass is compared.
+    Analysis::Formant::FeatureExtractor extractor;
+    rpm::vector<float> features(count * numFeatures);
+
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < count; ++i) {
+        extractor.compute(frames.data() + i * length, length, features.data() + i * numFeatures);
+    }
+    const double featureTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / count;
+
+    DenseNetwork reference(":/model.bin", DenseNetwork::Precision::Float32);
+    DenseNetwork quantized(":/model.bin", DenseNetwork::Precision::Int8);
+
+    rpm::vector<float> refOutputs, quantOutputs;
+
+    // The first pass pages in the weights and sizes the buffers.
+    timeNetwork(reference, features, count, true, refOutputs);
+    timeNetwork(quantized, features, count, true, quantOutputs);
+
+    const double refSingle = timeNetwork(reference, features, count, false, refOutputs);
+    const double quantSingle = timeNetwork(quantized, features, count, false, quantOutputs);
+    const double refBatched = timeNetwork(reference, features, count, true, refOutputs);
+    const double quantBatched = timeNetwork(quantized, features, count, true, quantOutputs);
+
+    std::cout << fileCount << " files, " << count << " frames of " << length << " samples at 16 kHz" << std::endl;
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << std::endl;
+    std::cout << "us per frame          float32       int8    speedup" << std::endl;
+    std::cout << "  one at a time  " << std::setw(12) << 1e6 * refSingle << std::setw(11) << 1e6 * quantSingle
+              << std::setw(10) << refSingle / quantSingle << "x" << std::endl;
+    std::cout << "  batched        " << std::setw(12) << 1e6 * refBatched << std::setw(11) << 1e6 * quantBatched
+              << std::setw(10) << refBatched / quantBatched << "x" << std::endl;
+    std::cout << "  features       " << std::setw(12) << 1e6 * featureTime << "   (shared by both)" << std::endl;
+    std::cout << std::endl;
+    std::cout << "int8 vs float32    mean Hz     p95 Hz     max Hz   mean rel %" << std::endl;
+
+    const int outputs = reference.getOutputLength();
+
+    for (int k = 0; k < std::min(numFormants, outputs); ++k) {
+        rpm::vector<double> diffs(count);
+        double relative = 0;
+        for (int i = 0; i < count; ++i) {
+            const double ref = 1000.0 * refOutputs[i * outputs + k];
+            diffs[i] = std::abs(1000.0 * quantOutputs[i * outputs + k] - ref);
+            relative += diffs[i] / std::max(std::abs(ref), 1.0);
+        }
+
+        double mean = 0;
+        for (double d : diffs)
+            mean += d;
+        mean /= count;
+
+        std::sort(diffs.begin(), diffs.end());
+        const double p95 = diffs[std::min<int>(count - 1, 0.95 * count)];
+
+        std::cout << "  F" << (k + 1) << "         " << std::setw(12) << mean << std::setw(11) << p95
+                  << std::setw(11) << diffs.back() << std::setw(13) << 100 * relative / count << std::endl;
+    }
+
+    return EXIT_SUCCESS;
+}
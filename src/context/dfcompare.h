@@ -0,0 +1,17 @@
+#ifndef MAIN_DF_COMPARE_H
+#define MAIN_DF_COMPARE_H
+
+#include "config.h"
+#include <string>
+
+namespace Main {
+
+    // Runs the float32 and int8 DeepFormants networks of the built-in engine over
+    // a corpus of WAV files (or directories of them), and prints how fast each
+    // one is and how far the int8 formants are from the float32 ones.
+    // Returns the process exit code.
+    int compareDeepFormants(Config *config, const rpm::vector<std::string>& paths);
+
+}
+
+#endif // MAIN_DF_COMPARE_H
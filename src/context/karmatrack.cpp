@@ -0,0 +1,92 @@
+#include "karmatrack.h"
+#include "wavfile.h"
+#include "../analysis/analysis.h"
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+
+using namespace Main;
+
+static constexpr double fsLPC = 11000;
+static constexpr int lpcOrder = 10;
+
+// Frames more than 40 dB below the loudest one are left out, as the pipeline
+// only runs the formant solver on voiced audio.
+static constexpr double silenceThreshold = 1e-4;
+
+int Main::trackKarmaFormants(Config *config, const std::string& path)
+{
+    rpm::vector<double> x;
+    int sampleRate;
+    if (!readWav(path, x, sampleRate)) {
+        std::cerr << path << ": not a supported WAV file" << std::endl;
+        return EXIT_FAILURE;
+    }
+    if (sampleRate != (int) fsLPC) {
+        Module::Audio::Resampler resampler(sampleRate, fsLPC);
+        x = resampler.process(x.data(), x.size());
+    }
+
+    const int length = std::round(config->getAnalysisFormantFrameLength() / 1000.0 * fsLPC);
+    const int hop = std::max<int>(1, std::round(config->getAnalysisFormantFrameHop() / 1000.0 * fsLPC));
+
+    rpm::vector<double> energies;
+    for (int start = 0; start + length <= (int) x.size(); start += hop) {
+        double e = 0;
+        for (int i = 0; i < length; ++i)
+            e += x[start + i] * x[start + i];
+        energies.push_back(e);
+    }
+    if (energies.empty()) {
+        std::cerr << "No frames to analyse" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    const double threshold = silenceThreshold * *std::max_element(energies.begin(), energies.end());
+
+    // Same preparation as the pipeline: 100 Hz preemphasis and a Gaussian window.
+    const double preemphFactor = exp(-(2.0 * M_PI * 100) / fsLPC);
+    const auto window = Analysis::gaussianWindow(length, 2.5);
+
+    rpm::vector<double> frames;
+    rpm::vector<double> times;
+
+    for (int f = 0; f < (int) energies.size(); ++f) {
+        if (energies[f] <= threshold)
+            continue;
+        const double *in = x.data() + f * hop;
+        frames.push_back(window[0] * in[0]);
+        for (int i = 1; i < length; ++i)
+            frames.push_back(window[i] * (in[i] - preemphFactor * in[i - 1]));
+        times.push_back((f * hop + length / 2) / fsLPC);
+    }
+
+    const int count = times.size();
+
+    std::unique_ptr<Analysis::LinpredSolver> linpredSolver(
+            makeLinpredSolver(config->getLinpredAlgorithm(), LinpredOrderSelection::Fixed));
+    rpm::vector<double> lpc(count * lpcOrder);
+    rpm::vector<double> gains(count);
+    linpredSolver->solveBatch(frames.data(), count, length, length, lpcOrder, lpc.data(), gains.data());
+
+    Analysis::Formant::Karma karma;
+    rpm::vector<Analysis::FormantResult> results(count);
+    karma.smooth(lpc.data(), count, lpcOrder, fsLPC, results.data());
+
+    std::cout << "time,F1,F2,F3,B1,B2,B3" << std::endl;
+    std::cout << std::fixed << std::setprecision(1);
+    for (int t = 0; t < count; ++t) {
+        const auto& formants = results[t].formants;
+        std::cout << std::setprecision(4) << times[t] << std::setprecision(1);
+        for (const auto& formant : formants)
+            std::cout << "," << formant.frequency;
+        for (const auto& formant : formants)
+            std::cout << "," << formant.bandwidth;
+        std::cout << "\n";
+    }
+    std::cout << std::flush;
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,16 @@
+#ifndef MAIN_KARMA_TRACK_H
+#define MAIN_KARMA_TRACK_H
+
+#include "config.h"
+#include <string>
+
+namespace Main {
+
+    // Tracks the formants of a whole WAV file with Karma's Rauch-Tung-Striebel
+    // smoother and prints them to stdout as CSV, one line per frame.
+    // Returns the process exit code.
+    int trackKarmaFormants(Config *config, const std::string& path);
+
+}
+
+#endif // MAIN_KARMA_TRACK_H
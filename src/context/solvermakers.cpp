@@ -1,9 +1,10 @@
 #include "solvermakers.h"
+#include <cmath>
 #include <stdexcept>
 
 using namespace Main;
 
-Analysis::PitchSolver *Main::makePitchSolver(PitchAlgorithm alg)
+Analysis::PitchSolver *Main::makePitchSolver(PitchAlgorithm alg, int lookahead)
 {
     switch (alg) {
     case PitchAlgorithm::Yin:
@@ -11,13 +12,19 @@ Analysis::PitchSolver *Main::makePitchSolver(PitchAlgorithm alg)
     case PitchAlgorithm::MPM:
         return new Analysis::Pitch::MPM;
     case PitchAlgorithm::RAPT:
-        return new Analysis::Pitch::RAPT;
+        return new Analysis::Pitch::RAPT(lookahead);
+    case PitchAlgorithm::StreamingYin:
+        return new Analysis::Pitch::StreamingYin(0.15, 60.0, 1000.0);
+    case PitchAlgorithm::AMDF_M:
+        return new Analysis::Pitch::AMDF_M(60.0, 1000.0, 0.9);
+    case PitchAlgorithm::IRAPT:
+        return new Analysis::Pitch::IRAPT;
     default:
         throw std::runtime_error("ContextManager] Unknown pitch estimation algorithm.");
     }
 }
 
-Analysis::LinpredSolver *Main::makeLinpredSolver(LinpredAlgorithm alg)
+static Analysis::LinpredSolver *makeFixedOrderLinpredSolver(LinpredAlgorithm alg)
 {
     switch (alg) {
     case LinpredAlgorithm::Autocorr:
@@ -31,7 +38,21 @@ Analysis::LinpredSolver *Main::makeLinpredSolver(LinpredAlgorithm alg)
     }
 }
 
-Analysis::FormantSolver *Main::makeFormantSolver(FormantAlgorithm alg)
+Analysis::LinpredSolver *Main::makeLinpredSolver(LinpredAlgorithm alg, LinpredOrderSelection selection)
+{
+    switch (selection) {
+    case LinpredOrderSelection::Fixed:
+        return makeFixedOrderLinpredSolver(alg);
+    case LinpredOrderSelection::AIC:
+        return new Analysis::LP::OrderSelection(makeFixedOrderLinpredSolver(alg), Analysis::LP::OrderCriterion::AIC);
+    case LinpredOrderSelection::MDL:
+        return new Analysis::LP::OrderSelection(makeFixedOrderLinpredSolver(alg), Analysis::LP::OrderCriterion::MDL);
+    default:
+        throw std::runtime_error("ContextManager] Unknown linear prediction order selection.");
+    }
+}
+
+Analysis::FormantSolver *Main::makeFormantSolver(FormantAlgorithm alg, int deepFormantsThreads)
 {
     switch (alg) {
     case FormantAlgorithm::Simple:
@@ -39,7 +60,13 @@ Analysis::FormantSolver *Main::makeFormantSolver(FormantAlgorithm alg)
     case FormantAlgorithm::Filtered:
         return new Analysis::Formant::FilteredLP;
     case FormantAlgorithm::Deep:
-        return new Analysis::Formant::DeepFormants;
+        return new Analysis::Formant::DeepFormants(deepFormantsThreads);
+    case FormantAlgorithm::Envelope:
+        return new Analysis::Formant::EnvelopeLP;
+    case FormantAlgorithm::Karma:
+        return new Analysis::Formant::Karma;
+    case FormantAlgorithm::DeepInt8:
+        return new Analysis::Formant::DeepFormants(deepFormantsThreads, true);
     default:
         throw std::runtime_error("ContextManager] Unknown formant estimation algorithm.");
     }
@@ -56,3 +83,70 @@ Analysis::InvglotSolver *Main::makeInvglotSolver(InvglotAlgorithm alg)
         throw std::runtime_error("ContextManager] Unknown glottal inverse filtering algorithm.");
     }
 }
+
+static rpm::vector<double> warmUpFrame(double sampleRate, double duration)
+{
+    rpm::vector<double> x(sampleRate * duration);
+    for (int i = 0; i < (int) x.size(); ++i) {
+        const double t = i / sampleRate;
+        x[i] = 0.5 * sin(2 * M_PI * 150 * t) + 0.25 * sin(2 * M_PI * 700 * t);
+    }
+    return x;
+}
+
+void Main::warmUp(Analysis::PitchSolver& solver)
+{
+    auto x = warmUpFrame(48000, 0.04);
+    for (int i = 0; i < 2; ++i) {
+        solver.solve(x.data(), x.size(), 48000);
+    }
+    solver.reset();
+}
+
+void Main::warmUp(Analysis::LinpredSolver& solver)
+{
+    auto x = warmUpFrame(11000, 0.02);
+    double gain;
+    solver.solve(x.data(), x.size(), 10, &gain);
+}
+
+void Main::warmUp(Analysis::FormantSolver& solver)
+{
+    if (auto deepFormantSolver = dynamic_cast<Analysis::Formant::DeepFormants *>(&solver)) {
+        // Model inference is what is slow the first time around.
+        auto x = warmUpFrame(16000, 0.02);
+        for (int i = 0; i < 2; ++i) {
+            deepFormantSolver->setFrameAudio(x);
+            deepFormantSolver->solve(nullptr, 0, 11000);
+        }
+        // Batched shapes are profiled separately.
+        constexpr int count = 4;
+        rpm::vector<double> frames;
+        for (int i = 0; i < count; ++i)
+            frames.insert(frames.end(), x.begin(), x.end());
+        rpm::vector<Analysis::FormantResult> results(count);
+        deepFormantSolver->solveFrames(frames.data(), count, x.size(), x.size(), results.data());
+    }
+    else {
+        // Two resonances at 700 Hz and 1200 Hz.
+        const double fs = 11000;
+        const double r = 0.97;
+        const double a1 = -2 * r * cos(2 * M_PI * 700 / fs);
+        const double b1 = -2 * r * cos(2 * M_PI * 1200 / fs);
+        const double r2 = r * r;
+        rpm::vector<double> lpc {
+            a1 + b1,
+            2 * r2 + a1 * b1,
+            r2 * (a1 + b1),
+            r2 * r2,
+        };
+        solver.solve(lpc.data(), lpc.size(), fs);
+    }
+    solver.reset();
+}
+
+void Main::warmUp(Analysis::InvglotSolver& solver)
+{
+    auto x = warmUpFrame(8000, 0.08);
+    solver.solve(x.data(), x.size(), 8000);
+}
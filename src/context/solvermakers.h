@@ -9,9 +9,13 @@ namespace Main {
         Yin,
         MPM,
         RAPT,
+        StreamingYin,
+        AMDF_M,
+        IRAPT,
     };
     
-    Analysis::PitchSolver *makePitchSolver(PitchAlgorithm alg);
+    // The lookahead (in frames) is used by solvers that decode a path over several frames.
+    Analysis::PitchSolver *makePitchSolver(PitchAlgorithm alg, int lookahead);
     
     enum class LinpredAlgorithm : int64_t {
         Autocorr,
@@ -19,15 +23,26 @@ namespace Main {
         Burg,
     };
 
-    Analysis::LinpredSolver *makeLinpredSolver(LinpredAlgorithm alg);
+    enum class LinpredOrderSelection : int64_t {
+        Fixed,
+        AIC,
+        MDL,
+    };
+
+    // Unless the selection is Fixed, the order passed to the solver is the highest one tried.
+    Analysis::LinpredSolver *makeLinpredSolver(LinpredAlgorithm alg, LinpredOrderSelection selection);
 
     enum class FormantAlgorithm : int64_t {
         Simple,
         Filtered,
         Deep,
+        Envelope,
+        Karma,
+        DeepInt8,
     };
 
-    Analysis::FormantSolver *makeFormantSolver(FormantAlgorithm alg);
+    // deepFormantsThreads sets libtorch's intra-op thread count in WITH_TORCH builds, 0 keeps its default.
+    Analysis::FormantSolver *makeFormantSolver(FormantAlgorithm alg, int deepFormantsThreads);
 
     enum class InvglotAlgorithm : int64_t {
         IAIF,
@@ -36,6 +51,13 @@ namespace Main {
 
     Analysis::InvglotSolver *makeInvglotSolver(InvglotAlgorithm alg);
 
+    // Run a few solves on synthetic frames so that plans, caches and
+    // lazily-initialised models are ready before the solver goes live.
+    void warmUp(Analysis::PitchSolver& solver);
+    void warmUp(Analysis::LinpredSolver& solver);
+    void warmUp(Analysis::FormantSolver& solver);
+    void warmUp(Analysis::InvglotSolver& solver);
+
 }
 
 #endif // MAIN_SOLVER_MAKERS_H
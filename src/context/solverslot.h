@@ -0,0 +1,183 @@
+#ifndef MAIN_SOLVER_SLOT_H
+#define MAIN_SOLVER_SLOT_H
+
+#include "rpcxx.h"
+#include "solvermakers.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace Main {
+
+    /*
+     *  Holds the solver used by the analysis threads and swaps it without
+     *  ever blocking them.
+     *
+     *  Readers take a snapshot with get() at the start of each frame and keep
+     *  it until the frame is done. A replacement is built and warmed up on
+     *  the slot's own worker thread, then published atomically: frames in
+     *  flight finish on the old solver, the next frames pick up the new one.
+     *  Retired solvers are released by the worker once no reader holds them.
+     */
+    template<typename T>
+    class SolverSlot {
+    public:
+        using Factory = std::function<T *()>;
+
+        explicit SolverSlot(T *solver);
+        ~SolverSlot();
+
+        SolverSlot(const SolverSlot&) = delete;
+        SolverSlot& operator=(const SolverSlot&) = delete;
+
+        std::shared_ptr<T> get() const;
+
+        // Newer requests supersede pending ones that have not been published yet.
+        void request(Factory factory);
+
+    private:
+        // Once the last holder lets go, the solver is handed back to the worker for deletion.
+        std::shared_ptr<T> adopt(T *solver);
+
+        void workerLoop();
+
+        std::shared_ptr<T> mSolver;
+
+        std::mutex mMutex;
+        std::condition_variable mCond;
+        Factory mPending;
+        uint64_t mGeneration;
+        bool mStop;
+
+        rpm::vector<T *> mRetired;
+
+        std::thread mWorker;
+    };
+
+    template<typename T>
+    SolverSlot<T>::SolverSlot(T *solver)
+        : mGeneration(0),
+          mStop(false)
+    {
+        mSolver = adopt(solver);
+    }
+
+    template<typename T>
+    SolverSlot<T>::~SolverSlot()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mStop = true;
+        }
+        mCond.notify_one();
+
+        if (mWorker.joinable())
+            mWorker.join();
+
+        // Without the worker, deleters run in place.
+        std::atomic_store(&mSolver, std::shared_ptr<T>());
+        for (T *solver : mRetired) {
+            delete solver;
+        }
+    }
+
+    template<typename T>
+    std::shared_ptr<T> SolverSlot<T>::get() const
+    {
+        return std::atomic_load(&mSolver);
+    }
+
+    template<typename T>
+    std::shared_ptr<T> SolverSlot<T>::adopt(T *solver)
+    {
+        // The last holder is usually an analysis thread, which should not pay for the deletion.
+        return std::shared_ptr<T>(solver, [this](T *retired) {
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                if (!mStop) {
+                    mRetired.push_back(retired);
+                    mCond.notify_one();
+                    return;
+                }
+            }
+            delete retired;
+        });
+    }
+
+    template<typename T>
+    void SolverSlot<T>::request(Factory factory)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mPending = std::move(factory);
+            mGeneration++;
+
+            // Only spawned on the first swap, most slots never need one.
+            if (!mWorker.joinable()) {
+                mWorker = std::thread(std::mem_fn(&SolverSlot<T>::workerLoop), this);
+            }
+        }
+        mCond.notify_one();
+    }
+
+    template<typename T>
+    void SolverSlot<T>::workerLoop()
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+
+        while (true) {
+            mCond.wait(lock, [this] { return mStop || mPending || !mRetired.empty(); });
+            if (mStop) {
+                break;
+            }
+
+            Factory factory = std::move(mPending);
+            mPending = nullptr;
+            const uint64_t generation = mGeneration;
+
+            rpm::vector<T *> retired;
+            retired.swap(mRetired);
+
+            lock.unlock();
+
+            for (T *solver : retired) {
+                delete solver;
+            }
+
+            std::shared_ptr<T> solver;
+            if (factory) {
+                try {
+                    solver = adopt(factory());
+                    warmUp(*solver);
+                }
+                catch (const std::exception& e) {
+                    std::cerr << "SolverSlot] Could not build solver: " << e.what() << std::endl;
+                    solver.reset();
+                }
+            }
+
+            std::shared_ptr<T> previous;
+
+            lock.lock();
+
+            // Publish only if no newer request came in while building.
+            if (solver && generation == mGeneration && !mStop) {
+                previous = std::atomic_exchange(&mSolver, solver);
+            }
+
+            // Both deleters take the lock.
+            lock.unlock();
+            previous.reset();
+            solver.reset();
+            lock.lock();
+        }
+    }
+
+}
+
+#endif // MAIN_SOLVER_SLOT_H
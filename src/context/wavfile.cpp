@@ -0,0 +1,73 @@
+#include "wavfile.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+static uint32_t readLE(const char *p, int bytes)
+{
+    uint32_t v = 0;
+    for (int i = 0; i < bytes; ++i)
+        v |= (uint32_t) (uint8_t) p[i] << (8 * i);
+    return v;
+}
+
+bool Main::readWav(const fs::path& path, rpm::vector<double>& x, int& sampleRate)
+{
+    std::ifstream file(path, std::ios::binary);
+    rpm::vector<char> buf((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    if (buf.size() < 12 || std::memcmp(buf.data(), "RIFF", 4) != 0 || std::memcmp(buf.data() + 8, "WAVE", 4) != 0)
+        return false;
+
+    int format = 0, channels = 0, bits = 0;
+    sampleRate = 0;
+
+    size_t pos = 12;
+    while (pos + 8 <= buf.size()) {
+        const char *chunk = buf.data() + pos;
+        const size_t size = std::min<size_t>(readLE(chunk + 4, 4), buf.size() - pos - 8);
+        const char *data = chunk + 8;
+
+        if (std::memcmp(chunk, "fmt ", 4) == 0 && size >= 16) {
+            format = readLE(data, 2);
+            channels = readLE(data + 2, 2);
+            sampleRate = readLE(data + 4, 4);
+            bits = readLE(data + 14, 2);
+            if (format == 0xFFFE && size >= 26)
+                format = readLE(data + 24, 2);
+        }
+        else if (std::memcmp(chunk, "data", 4) == 0) {
+            const bool isFloat = (format == 3 && bits == 32);
+            if ((format != 1 && !isFloat) || channels <= 0 || sampleRate <= 0
+                    || (bits != 16 && bits != 24 && bits != 32))
+                return false;
+
+            const int width = bits / 8;
+            const int count = size / (width * channels);
+            x.assign(count, 0.0);
+
+            for (int i = 0; i < count; ++i) {
+                for (int c = 0; c < channels; ++c) {
+                    const char *p = data + (i * channels + c) * width;
+                    double v;
+                    if (isFloat) {
+                        float f;
+                        std::memcpy(&f, p, 4);
+                        v = f;
+                    }
+                    else {
+                        // Sign extends from the top byte.
+                        const int32_t s = (int32_t) (readLE(p, width) << (32 - bits));
+                        v = s / 2147483648.0;
+                    }
+                    x[i] += v / channels;
+                }
+            }
+            return true;
+        }
+
+        pos += 8 + size + (size & 1);
+    }
+    return false;
+}
@@ -0,0 +1,15 @@
+#ifndef MAIN_WAV_FILE_H
+#define MAIN_WAV_FILE_H
+
+#include "rpcxx.h"
+#include "../filesystem.hpp"
+
+namespace Main {
+
+    // PCM 16, 24 or 32 bit integer or 32 bit float, channels are averaged.
+    // Returns false if the file is not one of those.
+    bool readWav(const fs::path& path, rpm::vector<double>& x, int& sampleRate);
+
+}
+
+#endif // MAIN_WAV_FILE_H
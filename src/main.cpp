@@ -1,11 +1,15 @@
 #include "modules/modules.h"
 #include "analysis/analysis.h"
 #include "context/contextmanager.h"
+#include "context/dfcompare.h"
+#include "context/karmatrack.h"
 #include <iostream>
 #include <atomic>
 #include <memory>
 #include <chrono>
 #include <csignal>
+#include <cstdlib>
+#include <cstring>
 #include <thread>
 
 #include <QApplication>
@@ -19,6 +23,7 @@ using namespace std::chrono_literals;
 
 static std::atomic_bool signalCaught(false);
 static std::atomic_int signalStatus;
+static std::atomic<App::Service *> runningService(nullptr);
 
 static void signalHandler(int signal) {
     signalCaught = true;
@@ -33,7 +38,36 @@ static void signalHandler(int signal) {
         break;
     }
 
-    QMetaObject::invokeMethod(qGuiApp, "quit");
+    if (App::Service *service = runningService) {
+        service->stop();
+    }
+    else {
+        QMetaObject::invokeMethod(qGuiApp, "quit");
+    }
+}
+
+static int runService(const char *socketPath)
+{
+    auto config = std::make_unique<Main::Config>();
+    auto service = std::make_unique<App::Service>(config.get(), socketPath);
+
+    runningService = service.get();
+    int retCode = service->exec();
+    runningService = nullptr;
+
+    return retCode;
+}
+
+static int runCompareDeepFormants(int argc, char **argv)
+{
+    auto config = std::make_unique<Main::Config>();
+    return Main::compareDeepFormants(config.get(), rpm::vector<std::string>(argv, argv + argc));
+}
+
+static int runTrackKarmaFormants(const char *path)
+{
+    auto config = std::make_unique<Main::Config>();
+    return Main::trackKarmaFormants(config.get(), path);
 }
 
 int start_logger(const char *app_name);
@@ -57,6 +91,33 @@ int main(int argc, char **argv)
     Main::argc = argc;
     Main::argv = argv;
 
+    // Headless mode: serve analysis to local clients instead of opening the GUI.
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--service") == 0) {
+            if (i + 1 >= argc) {
+                std::cerr << "Usage: " << argv[0] << " --service <socket path>" << std::endl;
+                return EXIT_FAILURE;
+            }
+            return runService(argv[i + 1]);
+        }
+        // Accuracy and speed of the int8 DeepFormants model over a corpus of WAV files.
+        if (std::strcmp(argv[i], "--compare-deepformants") == 0) {
+            if (i + 1 >= argc) {
+                std::cerr << "Usage: " << argv[0] << " --compare-deepformants <WAV files or directories...>" << std::endl;
+                return EXIT_FAILURE;
+            }
+            return runCompareDeepFormants(argc - i - 1, argv + i + 1);
+        }
+        // Offline formant tracks of a WAV file, smoothed over the whole file.
+        if (std::strcmp(argv[i], "--track-formants") == 0) {
+            if (i + 1 >= argc) {
+                std::cerr << "Usage: " << argv[0] << " --track-formants <WAV file>" << std::endl;
+                return EXIT_FAILURE;
+            }
+            return runTrackKarmaFormants(argv[i + 1]);
+        }
+    }
+
     auto contextManager = std::make_unique<Main::ContextManager>(
             48'000,     // captureSampleRate
             50ms,       // playbackDuration
@@ -2,6 +2,7 @@
 #define MODULES_APP_H
 
 #include "pipeline/pipeline.h"
+#include "service/service.h"
 #include "synthesizer/synthesizer.h"
 
 #endif // MODULES_APP_H
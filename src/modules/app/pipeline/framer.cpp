@@ -0,0 +1,200 @@
+#include "framer.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+using namespace Module::App;
+
+Framer::Framer(double sampleRate, double capacityInSeconds)
+    : mCapacityInSeconds(capacityInSeconds),
+      mTimeOffset(0),
+      mDelay(0),
+      mWritePosition(0),
+      mCancel(false)
+{
+    allocate(sampleRate);
+}
+
+double Framer::getSampleRate() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mSampleRate;
+}
+
+int64_t Framer::getWritePosition() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mWritePosition;
+}
+
+int Framer::addConsumer(double windowDuration, double hopDuration)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    Consumer c;
+    c.windowDuration = windowDuration;
+    c.hopDuration = hopDuration;
+    c.windowLength = std::max<int>(1, std::round(windowDuration * mSampleRate));
+    c.hopLength = std::max<int>(1, std::round(hopDuration * mSampleRate));
+    c.next = mWritePosition;
+    c.held = -1;
+
+    if (c.windowLength > mCapacity) {
+        throw std::runtime_error("Framer] Window is longer than the buffer capacity");
+    }
+
+    mConsumers.push_back(c);
+    return mConsumers.size() - 1;
+}
+
+void Framer::reset(double sampleRate, double timeOffset)
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+
+    mFrameReleased.wait(lock, [this] {
+        return mCancel || std::none_of(mConsumers.begin(), mConsumers.end(),
+                    [](const Consumer& c) { return c.held >= 0; });
+    });
+
+    allocate(sampleRate);
+
+    mTimeOffset = timeOffset;
+    mDelay = 0;
+    mWritePosition = 0;
+
+    for (auto& c : mConsumers) {
+        c.windowLength = std::max<int>(1, std::round(c.windowDuration * mSampleRate));
+        c.hopLength = std::max<int>(1, std::round(c.hopDuration * mSampleRate));
+        c.next = 0;
+    }
+}
+
+void Framer::setDelay(double delay)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    mDelay = delay;
+}
+
+void Framer::push(const double *pIn, int inLength)
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+
+    int done = 0;
+
+    while (done < inLength && !mCancel) {
+        // Consumers that are not holding a frame and fell behind skip ahead
+        // to the oldest frame that will still be in the buffer.
+        const int64_t limit = mWritePosition + (inLength - done) - mCapacity;
+        for (auto& c : mConsumers) {
+            if (c.held < 0 && c.next < limit) {
+                c.next += ((limit - c.next + c.hopLength - 1) / c.hopLength) * c.hopLength;
+            }
+        }
+
+        // A held frame must never be overwritten.
+        const int count = std::min<int64_t>(inLength - done, oldestNeeded() + mCapacity - mWritePosition);
+        if (count <= 0) {
+            mFrameReleased.wait(lock);
+            continue;
+        }
+
+        for (int i = 0; i < count; ++i) {
+            const int index = (mWritePosition + i) & mMask;
+            mData[index] = mData[index + mCapacity] = pIn[done + i];
+        }
+
+        mWritePosition += count;
+        done += count;
+
+        mFrameReady.notify_all();
+    }
+}
+
+bool Framer::pull(int id, Frame& frame)
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+
+    mFrameReady.wait(lock, [this, id] {
+        const auto& c = mConsumers[id];
+        return mCancel || mWritePosition >= c.next + c.windowLength;
+    });
+
+    if (mCancel) {
+        return false;
+    }
+
+    takeFrame(mConsumers[id], frame);
+    return true;
+}
+
+bool Framer::tryPull(int id, Frame& frame)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    auto& c = mConsumers[id];
+    if (mCancel || mWritePosition < c.next + c.windowLength) {
+        return false;
+    }
+
+    takeFrame(c, frame);
+    return true;
+}
+
+void Framer::release(int id)
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mConsumers[id].held = -1;
+    }
+    mFrameReleased.notify_all();
+}
+
+void Framer::cancel()
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mCancel = true;
+    }
+    mFrameReady.notify_all();
+    mFrameReleased.notify_all();
+}
+
+void Framer::allocate(double sampleRate)
+{
+    mSampleRate = sampleRate;
+
+    int minCapacity = std::ceil(mCapacityInSeconds * sampleRate);
+    for (const auto& c : mConsumers) {
+        minCapacity = std::max<int>(minCapacity, 2 * std::round(c.windowDuration * sampleRate));
+    }
+
+    mCapacity = 1;
+    while (mCapacity < minCapacity) {
+        mCapacity <<= 1;
+    }
+    mMask = mCapacity - 1;
+
+    mData.assign(2 * mCapacity, 0.0);
+}
+
+void Framer::takeFrame(Consumer& c, Frame& frame)
+{
+    c.held = c.next;
+
+    frame.data = &mData[c.next & mMask];
+    frame.length = c.windowLength;
+    frame.start = c.next;
+    frame.time = mTimeOffset + (c.next - mDelay) / mSampleRate;
+    frame.sampleRate = mSampleRate;
+
+    c.next += c.hopLength;
+}
+
+int64_t Framer::oldestNeeded() const
+{
+    int64_t oldest = mWritePosition;
+    for (const auto& c : mConsumers) {
+        oldest = std::min(oldest, c.held >= 0 ? c.held : c.next);
+    }
+    return oldest;
+}
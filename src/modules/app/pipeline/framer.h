@@ -0,0 +1,93 @@
+#ifndef APP_FRAMER_H
+#define APP_FRAMER_H
+
+#include "rpcxx.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+
+namespace Module::App
+{
+    /*
+     *  Splits one audio stream into overlapping frames for several consumers.
+     *
+     *  Samples are kept in a mirrored ring buffer (every sample is stored twice,
+     *  capacity apart) so that any frame up to the capacity is contiguous in
+     *  memory and can be handed out without copying. Each consumer has its own
+     *  window length and hop, and every frame is timestamped from its sample
+     *  index on the shared timeline.
+     *
+     *  NOTE: There can be only one writer, and each consumer must be pulled
+     *        from a single thread.
+     */
+    class Framer {
+    public:
+        struct Frame {
+            const double *data;
+            int length;
+            int64_t start;
+            double time;
+            double sampleRate;
+        };
+
+        Framer(double sampleRate, double capacityInSeconds = 2.0);
+
+        double getSampleRate() const;
+        int64_t getWritePosition() const;
+
+        // Window and hop are given in seconds and follow the stream across rate changes.
+        int addConsumer(double windowDuration, double hopDuration);
+
+        // Restarts the timeline, e.g. after the stream was resampled to another rate.
+        // Waits until no frame is held by a consumer.
+        void reset(double sampleRate, double timeOffset);
+
+        // Shift applied to the frame timestamps, in samples (e.g. a resampler delay).
+        void setDelay(double delay);
+
+        void push(const double *pIn, int inLength);
+
+        // Blocks until the consumer's next frame is complete.
+        // The frame stays valid until release() is called for that consumer.
+        bool pull(int id, Frame& frame);
+        bool tryPull(int id, Frame& frame);
+        void release(int id);
+
+        void cancel();
+
+    private:
+        struct Consumer {
+            double windowDuration;
+            double hopDuration;
+            int windowLength;
+            int hopLength;
+            int64_t next;
+            int64_t held;
+        };
+
+        void allocate(double sampleRate);
+        int64_t oldestNeeded() const;
+        void takeFrame(Consumer& c, Frame& frame);
+
+        double mSampleRate;
+        double mCapacityInSeconds;
+        double mTimeOffset;
+        double mDelay;
+
+        int mCapacity;
+        int mMask;
+        rpm::vector<double> mData;
+
+        int64_t mWritePosition;
+        rpm::vector<Consumer> mConsumers;
+
+        mutable std::mutex mMutex;
+        std::condition_variable mFrameReady;
+        std::condition_variable mFrameReleased;
+
+        std::atomic_bool mCancel;
+    };
+}
+
+#endif // APP_FRAMER_H
@@ -1,3 +1,4 @@
+
 #include "pipeline.h"
 #include "../../../analysis/filter/filter.h"
 #include "../../../synthesis/synthesis.h"
@@ -6,12 +7,16 @@
 
 using namespace Module::App;
 
+static constexpr double fsFormantsDF = 16000;
+static constexpr double fsFormantsLPC = 11000;
+static constexpr double fsOscilloscope = 8000;
+
 Pipeline::Pipeline(Module::Audio::Buffer *captureBuffer,
                 Main::DataStore *dataStore, Main::Config *config,
-                std::shared_ptr<Analysis::PitchSolver>& pitchSolver,
-                std::shared_ptr<Analysis::LinpredSolver>& linpredSolver,
-                std::shared_ptr<Analysis::FormantSolver>& formantSolver,
-                std::shared_ptr<Analysis::InvglotSolver>& invglotSolver)
+                Main::SolverSlot<Analysis::PitchSolver>& pitchSolver,
+                Main::SolverSlot<Analysis::LinpredSolver>& linpredSolver,
+                Main::SolverSlot<Analysis::FormantSolver>& formantSolver,
+                Main::SolverSlot<Analysis::InvglotSolver>& invglotSolver)
     : mCaptureBuffer(captureBuffer),
       mDataStore(dataStore),
       mConfig(config),
@@ -20,12 +25,12 @@ Pipeline::Pipeline(Module::Audio::Buffer *captureBuffer,
       mFormantSolver(formantSolver),
       mInvglotSolver(invglotSolver),
       mTime(0),
+      mBlockSize(512),
+      mLastBufferLength(0),
       mRunningThreads(false),
       mStopThreads(false),
-      mBufferSpectrogram(16000),
-      mBufferPitch(16000),
-      mBufferFormants(16000),
-      mBufferOscilloscope(16000)
+      mVoiceActivityEnabled(false),
+      mVoiceActivityUntil(-HUGE_VAL)
 {
 }
 
@@ -33,8 +38,17 @@ Pipeline::~Pipeline()
 {
     mRunningThreads = false;
     mStopThreads = true;
-    
-    Module::Audio::Buffer::cancelPulls();
+
+    {
+        std::lock_guard<std::mutex> lock(mVoiceActivityMutex);
+        mVoiceActivityCond.notify_all();
+    }
+
+    for (auto framer : { &mFramer, &mFramerSpectrogram, &mFramerFormantsDF, &mFramerFormantsLPC, &mFramerOscilloscope }) {
+        if (*framer) {
+            (*framer)->cancel();
+        }
+    }
 
     if (mThreadSpectrogram.joinable())
         mThreadSpectrogram.join();
@@ -49,44 +63,161 @@ Pipeline::~Pipeline()
         mThreadOscilloscope.join();
 }
 
-void Pipeline::callbackSpectrogram()
+void Pipeline::createFramers(double fs)
+{
+    mFramer = std::make_unique<Framer>(fs);
+    mConsumerPitch = mFramer->addConsumer(
+            mConfig->getAnalysisPitchFrameLength() / 1000.0,
+            mConfig->getAnalysisPitchFrameHop() / 1000.0);
+
+    constexpr double vadFrameLength = 30.0 / 1000.0;
+    constexpr double vadFrameHop = 10.0 / 1000.0;
+    mVoiceActivityEnabled = mConfig->getAnalysisVadEnabled();
+    mVoiceActivityDetector.setEnergyThreshold(mConfig->getAnalysisVadEnergyThreshold());
+    mVoiceActivityDetector.setMinimumEnergy(mConfig->getAnalysisVadMinimumEnergy());
+    mVoiceActivityDetector.setZeroCrossingThreshold(mConfig->getAnalysisVadZeroCrossingThreshold());
+    mVoiceActivityDetector.setFlatnessThreshold(mConfig->getAnalysisVadFlatnessThreshold());
+    mVoiceActivityDetector.setHangover(std::round(mConfig->getAnalysisVadHangover() / 1000.0 / vadFrameHop));
+    mConsumerVoiceActivity = mFramer->addConsumer(vadFrameLength, vadFrameHop);
+
+    const double dfs = 2 * mConfig->getViewMaxFrequency();
+    mSpectrumResampler.setRate(fs, dfs);
+    mSpectrumHighpass = Analysis::butterworthHighpass(8, 60.0, dfs);
+    mSpectrumHighpassMemory.assign(mSpectrumHighpass.size(), rpm::vector<double>(2, 0.0));
+    mFramerSpectrogram = std::make_unique<Framer>(dfs);
+    mFramerSpectrogram->setDelay(mSpectrumResampler.getDelay());
+    mConsumerSpectrogram = mFramerSpectrogram->addConsumer(
+            mConfig->getAnalysisSpectrogramFrameLength() / 1000.0,
+            mConfig->getAnalysisSpectrogramFrameHop() / 1000.0);
+
+    const double formantFrameLength = mConfig->getAnalysisFormantFrameLength() / 1000.0;
+    const double formantFrameHop = mConfig->getAnalysisFormantFrameHop() / 1000.0;
+
+    mFormantResamplerDF.setRate(fs, fsFormantsDF);
+    mFramerFormantsDF = std::make_unique<Framer>(fsFormantsDF);
+    mFramerFormantsDF->setDelay(mFormantResamplerDF.getDelay());
+    mConsumerFormantsDF = mFramerFormantsDF->addConsumer(formantFrameLength, formantFrameHop);
+
+    // Highest order tried when the order is selected per frame: one pole pair per kHz
+    // of formant range, as in the analysis settings. A fixed order stays at 10.
+    mFormantLpMaxOrder = std::round(mConfig->getAnalysisMaxFrequency() / 500.0) + mConfig->getAnalysisLpOffset();
+
+    mFormantResamplerLPC.setRate(fs, fsFormantsLPC);
+    mFramerFormantsLPC = std::make_unique<Framer>(fsFormantsLPC);
+    mFramerFormantsLPC->setDelay(mFormantResamplerLPC.getDelay());
+    mConsumerFormantsLPC = mFramerFormantsLPC->addConsumer(formantFrameLength, formantFrameHop);
+
+    mOscilloscopeResampler.setRate(fs, fsOscilloscope);
+    mFramerOscilloscope = std::make_unique<Framer>(fsOscilloscope);
+    mFramerOscilloscope->setDelay(mOscilloscopeResampler.getDelay());
+    mConsumerOscilloscope = mFramerOscilloscope->addConsumer(80.0 / 1000.0, 80.0 / 1000.0);
+}
+
+void Pipeline::pushFrames(const rpm::vector<double>& data)
+{
+    const double fs = mFramer->getSampleRate();
+    const int64_t position = mFramer->getWritePosition();
+
+    mFramer->push(data.data(), data.size());
+    detectVoiceActivity();
+
+    // The spectrogram follows the view's frequency range, restart its timeline on the current sample.
+    const double dfs = 2 * mConfig->getViewMaxFrequency();
+    if (dfs != mFramerSpectrogram->getSampleRate()) {
+        mSpectrumResampler.setRate(fs, dfs);
+        mSpectrumHighpass = Analysis::butterworthHighpass(8, 60.0, dfs);
+        mSpectrumHighpassMemory.assign(mSpectrumHighpass.size(), rpm::vector<double>(2, 0.0));
+        mFramerSpectrogram->reset(dfs, position / fs);
+        mFramerSpectrogram->setDelay(mSpectrumResampler.getDelay());
+    }
+
+    auto spectrum = mSpectrumResampler.process(data.data(), data.size());
+    spectrum = Synthesis::sosfilter(mSpectrumHighpass, spectrum, mSpectrumHighpassMemory);
+    mFramerSpectrogram->push(spectrum.data(), spectrum.size());
+
+    auto formantsDF = mFormantResamplerDF.process(data.data(), data.size());
+    mFramerFormantsDF->push(formantsDF.data(), formantsDF.size());
+
+    auto formantsLPC = mFormantResamplerLPC.process(data.data(), data.size());
+    mFramerFormantsLPC->push(formantsLPC.data(), formantsLPC.size());
+
+    auto oscilloscope = mOscilloscopeResampler.process(data.data(), data.size());
+    mFramerOscilloscope->push(oscilloscope.data(), oscilloscope.size());
+}
+
+void Pipeline::detectVoiceActivity()
+{
+    Framer::Frame frame;
+
+    while (mFramer->tryPull(mConsumerVoiceActivity, frame)) {
+        const bool active = !mVoiceActivityEnabled
+                || mVoiceActivityDetector.process(frame.data, frame.length).active;
+        mFramer->release(mConsumerVoiceActivity);
+
+        const double end = frame.time + frame.length / frame.sampleRate;
+
+        mDataStore->beginWrite();
+        mDataStore->getVoiceActivityTrack().insert(frame.time, active);
+        mDataStore->endWrite();
+
+        std::lock_guard<std::mutex> lock(mVoiceActivityMutex);
+        if (active) {
+            // Merge overlapping active frames into intervals.
+            if (!mVoiceActivity.empty() && frame.time <= mVoiceActivity.back().second) {
+                mVoiceActivity.back().second = end;
+            }
+            else {
+                mVoiceActivity.emplace_back(frame.time, end);
+            }
+        }
+        while (!mVoiceActivity.empty() && mVoiceActivity.front().second < end - 5.0) {
+            mVoiceActivity.pop_front();
+        }
+        mVoiceActivityUntil = end;
+        mVoiceActivityCond.notify_all();
+    }
+}
+
+bool Pipeline::isVoiceActive(double start, double end)
 {
-    const double fs = mCaptureBuffer->getSampleRate();
-    
-    constexpr double frameHop = 12.5 / 1000.0;
-    rpm::vector<double> m(frameHop * fs);
+    if (!mVoiceActivityEnabled) {
+        return true;
+    }
 
-    double frameDuration;
-    rpm::vector<double> slidingWindow;
-    
-    double t = 0;
+    std::unique_lock<std::mutex> lock(mVoiceActivityMutex);
 
+    // Frames from the resampled streams can run slightly ahead of the decisions.
+    mVoiceActivityCond.wait(lock, [&] {
+        return mStopThreads || mVoiceActivityUntil >= end;
+    });
+
+    for (auto it = mVoiceActivity.rbegin(); it != mVoiceActivity.rend(); ++it) {
+        if (it->first < end && it->second > start) {
+            return true;
+        }
+        if (it->second <= start) {
+            break;
+        }
+    }
+    return false;
+}
+
+void Pipeline::callbackSpectrogram()
+{
     double maxHold = 1.0;
 
-    auto hpsos = Analysis::butterworthHighpass(8, 60.0, fs);
-    rpm::vector<rpm::vector<double>> zfhp(hpsos.size(), rpm::vector<double>(2, 0.0));
+    Framer::Frame frame;
 
-    while (mRunningThreads && !mStopThreads) {
-        double dfs = 2 * mConfig->getViewMaxFrequency();
-        mSpectrumResampler.setRate(fs, dfs);
-        
+    while (mRunningThreads && !mStopThreads
+            && mFramerSpectrogram->pull(mConsumerSpectrogram, frame)) {
         int nfft = mConfig->getViewFFTSize();
         if (!mSpectrumFFT || mSpectrumFFT->getInputLength() != nfft) {
             mSpectrumFFT = std::make_unique<Analysis::RealFFT>(nfft);
-            frameDuration = 50.0 / 1000.0;
         }
-        
-        slidingWindow.resize(frameDuration * fs);
 
-        mBufferSpectrogram.pull(m.data(), m.size());
-        auto out = mSpectrumResampler.process(m.data(), m.size());
-        out = Synthesis::sosfilter(hpsos, out, zfhp);
+        auto fftVector = Analysis::fft_n(*mSpectrumFFT, frame.data, frame.length);
+        mFramerSpectrogram->release(mConsumerSpectrogram);
 
-        // Rotate to the left to make space for the latest chunk of audio.
-        std::rotate(slidingWindow.begin(), std::next(slidingWindow.begin(), out.size()), slidingWindow.end());
-        std::copy(out.begin(), out.end(), std::prev(slidingWindow.end(), out.size()));
-
-        auto fftVector = Analysis::fft_n(*mSpectrumFFT, slidingWindow); 
         Eigen::VectorXd spectrum = Eigen::Map<Eigen::VectorXd>(fftVector.data(), fftVector.size());
 
         double max = spectrum.maxCoeff();
@@ -94,134 +225,222 @@ void Pipeline::callbackSpectrogram()
         spectrum /= max;
 
         mDataStore->beginWrite();
-        mDataStore->getSpectrogram().insert(t - frameDuration - mSpectrumResampler.getDelay() / dfs, {
+        mDataStore->getSpectrogram().insert(frame.time, {
             .magnitudes = spectrum,
-            .sampleRate = dfs,
-            .frameDuration = frameDuration,
+            .sampleRate = frame.sampleRate,
+            .frameDuration = frame.length / frame.sampleRate,
         });
         mDataStore->endWrite();
-
-        t += m.size() / fs;
     }
 }
 
 void Pipeline::callbackPitch()
 {
-    const double fs = mCaptureBuffer->getSampleRate();
+    Framer::Frame frame;
 
-    rpm::vector<double> m(40.0 * fs / 1000.0);
+    // Times of the frames given to the current solver whose result has not come out yet.
+    rpm::deque<double> pendingTimes;
+    const Analysis::PitchSolver *lastSolver = nullptr;
 
-    double t = 0;
+    // Start of the last frame given to the current solver, -1 if the next one does not follow it.
+    int64_t lastStart = -1;
 
-    while (mRunningThreads && !mStopThreads) {
-        mBufferPitch.pull(m.data(), m.size());
+    rpm::vector<std::pair<double, std::optional<double>>> results;
 
-        auto pitchResult = mPitchSolver->solve(m.data(), m.size(), fs);
+    while (mRunningThreads && !mStopThreads
+            && mFramer->pull(mConsumerPitch, frame)) {
+        results.clear();
 
-        mDataStore->beginWrite();
-        if (pitchResult.voiced) {
-            mDataStore->getPitchTrack().insert(t, pitchResult.pitch);
+        if (isVoiceActive(frame.time, frame.time + frame.length / frame.sampleRate)) {
+            auto pitchSolver = mPitchSolver.get();
+
+            // A swapped-in solver starts its own delay line, the old one's pending frames are lost.
+            if (pitchSolver.get() != lastSolver) {
+                for (double t : pendingTimes) {
+                    results.emplace_back(t, std::nullopt);
+                }
+                pendingTimes.clear();
+                lastSolver = pitchSolver.get();
+                lastStart = -1;
+            }
+
+            pitchSolver->setFrameHop(lastStart >= 0 && frame.start > lastStart ? frame.start - lastStart : 0);
+            lastStart = frame.start;
+
+            auto pitchResult = pitchSolver->solve(frame.data, frame.length, frame.sampleRate);
+            pendingTimes.push_back(frame.time);
+
+            if ((int) pendingTimes.size() > pitchSolver->getFrameDelay()) {
+                results.emplace_back(pendingTimes.front(), pitchResult.voiced
+                                            ? std::optional<double>(pitchResult.pitch)
+                                            : std::nullopt);
+                pendingTimes.pop_front();
+            }
         }
         else {
-            mDataStore->getPitchTrack().insert(t, std::nullopt);
+            results.emplace_back(frame.time, std::nullopt);
+            lastStart = -1;
+        }
+        mFramer->release(mConsumerPitch);
+
+        mDataStore->beginWrite();
+        for (const auto& [time, pitch] : results) {
+            mDataStore->getPitchTrack().insert(time, pitch);
         }
         mDataStore->endWrite();
-        t += m.size() / fs;
     }
 }
 
-void Pipeline::callbackFormants()
+static void preemphasisAndWindow(const Framer::Frame& frame, rpm::vector<double>& window, rpm::vector<double>& out)
 {
-    double fs = mCaptureBuffer->getSampleRate();
+    constexpr double preemphFrequency = 100;
+    const double preemphFactor = exp(-(2.0 * M_PI * preemphFrequency) / frame.sampleRate);
 
-    rpm::vector<double> m(20.0 * fs / 1000.0);
+    if ((int) window.size() != frame.length) {
+        window = Analysis::gaussianWindow(frame.length, 2.5);
+    }
 
-    double preemphFrequency = 100;
-    double preemphFactor = exp(-(2.0 * M_PI * preemphFrequency) / fs);
-    rpm::vector<double> w = Analysis::gaussianWindow(m.size(), 2.5);
+    out.resize(frame.length);
+    out[0] = window[0] * frame.data[0];
+    for (int i = 1; i < frame.length; ++i) {
+        out[i] = window[i] * (frame.data[i] - preemphFactor * frame.data[i - 1]);
+    }
+}
 
-    double fsDF = 16000;
-    Module::Audio::Resampler rsDF(fs, fsDF);
+void Pipeline::insertFormants(double time, const Analysis::FormantResult *result)
+{
+    const int count = result ? result->formants.size() : 0;
+
+    mDataStore->beginWrite();
+    for (int i = 0; i < mDataStore->getFormantTrackCount(); ++i) {
+        if (i < count && std::isfinite(result->formants[i].frequency)) {
+            mDataStore->getFormantTrack(i).insert(time, result->formants[i].frequency);
+            mDataStore->getFormantBandwidthTrack(i).insert(time, result->formants[i].bandwidth);
+        }
+        else {
+            mDataStore->getFormantTrack(i).insert(time, std::nullopt);
+            mDataStore->getFormantBandwidthTrack(i).insert(time, std::nullopt);
+        }
+    }
+    mDataStore->endWrite();
+}
 
-    double fsLPC = 11000;
-    Module::Audio::Resampler rsLPC(fs, fsLPC);
+void Pipeline::callbackFormants()
+{
+    // Frames that are already complete when DeepFormants runs go through the model together.
+    constexpr int maxMicroBatch = 8;
 
-    double t = 0;
+    rpm::vector<double> windowDF, windowLPC;
+    rpm::vector<double> mDF, mLPC;
 
-    while (mRunningThreads && !mStopThreads) {
-        mBufferFormants.pull(m.data(), m.size());
+    rpm::vector<double> batchDF;
+    rpm::vector<double> batchTimes;
+    rpm::vector<Analysis::FormantResult> batchResults;
 
-        // Pre-emphasis and windowing.
-        for (int i = m.size() - 1; i >= 1; --i) {
-            m[i] = w[i] * (m[i] - preemphFactor * m[i - 1]);
-        }
+    Framer::Frame frameDF, frameLPC;
 
-        // Resample both regardless of the formant method in use.
-        auto mDF  = rsDF.process(m.data(), m.size());
-        auto mLPC = rsLPC.process(m.data(), m.size());
+    while (mRunningThreads && !mStopThreads
+            && mFramerFormantsDF->pull(mConsumerFormantsDF, frameDF)
+            && mFramerFormantsLPC->pull(mConsumerFormantsLPC, frameLPC)) {
+        if (!isVoiceActive(frameLPC.time, frameLPC.time + frameLPC.length / frameLPC.sampleRate)) {
+            mFramerFormantsDF->release(mConsumerFormantsDF);
+            mFramerFormantsLPC->release(mConsumerFormantsLPC);
 
-        rpm::vector<double> lpc;
-      
-        double delay;
-        if (auto deepFormantSolver = dynamic_cast<Analysis::Formant::DeepFormants *>(mFormantSolver.get())) {
-            deepFormantSolver->setFrameAudio(mDF);
-            delay = rsDF.getDelay() / fsDF;
-        }
-        else {
-            double gain;
-            lpc = mLinpredSolver->solve(mLPC.data(), mLPC.size(), 10, &gain);
-            delay = rsLPC.getDelay() / fsLPC;
+            insertFormants(frameLPC.time, nullptr);
+            continue;
         }
 
-        auto formantResult = mFormantSolver->solve(lpc.data(), lpc.size(), fsLPC);
-       
-        mDataStore->beginWrite();
-        for (int i = 0;
-                i < std::min<int>(
-                    mDataStore->getFormantTrackCount(),
-                    formantResult.formants.size());
-                ++i) {
-            const double freq = formantResult.formants[i].frequency;
-            if (std::isfinite(freq)) {
-                mDataStore->getFormantTrack(i).insert(t - delay, freq);
+        // Hold on to the same solvers for the whole frame, even if they get swapped meanwhile.
+        auto formantSolver = mFormantSolver.get();
+        auto linpredSolver = mLinpredSolver.get();
+
+        if (auto deepFormantSolver = dynamic_cast<Analysis::Formant::DeepFormants *>(formantSolver.get())) {
+            batchDF.clear();
+            batchTimes.clear();
+
+            std::optional<double> silenceAfter;
+
+            while (true) {
+                preemphasisAndWindow(frameDF, windowDF, mDF);
+                batchDF.insert(batchDF.end(), mDF.begin(), mDF.end());
+                batchTimes.push_back(frameDF.time);
+
+                mFramerFormantsDF->release(mConsumerFormantsDF);
+                mFramerFormantsLPC->release(mConsumerFormantsLPC);
+
+                // Never waits for audio that is not there yet.
+                if ((int) batchTimes.size() >= maxMicroBatch
+                        || !mFramerFormantsDF->tryPull(mConsumerFormantsDF, frameDF)) {
+                    break;
+                }
+                if (!mFramerFormantsLPC->pull(mConsumerFormantsLPC, frameLPC)) {
+                    mFramerFormantsDF->release(mConsumerFormantsDF);
+                    break;
+                }
+                if (!isVoiceActive(frameLPC.time, frameLPC.time + frameLPC.length / frameLPC.sampleRate)) {
+                    mFramerFormantsDF->release(mConsumerFormantsDF);
+                    mFramerFormantsLPC->release(mConsumerFormantsLPC);
+                    silenceAfter = frameLPC.time;
+                    break;
+                }
             }
-            else {
-                mDataStore->getFormantTrack(i).insert(t - delay, std::nullopt);
+
+            const int count = batchTimes.size();
+            const int length = mDF.size();
+
+            batchResults.resize(count);
+            deepFormantSolver->solveFrames(batchDF.data(), count, length, length, batchResults.data());
+
+            for (int i = 0; i < count; ++i) {
+                insertFormants(batchTimes[i], &batchResults[i]);
             }
+            if (silenceAfter) {
+                insertFormants(*silenceAfter, nullptr);
+            }
+            continue;
         }
-        for (int i = formantResult.formants.size(); i < mDataStore->getFormantTrackCount(); ++i) {
-            mDataStore->getFormantTrack(i).insert(t - delay, std::nullopt);
-        }
-        mDataStore->endWrite();
-        t += m.size() / fs;
+
+        preemphasisAndWindow(frameLPC, windowLPC, mLPC);
+        const double time = frameLPC.time;
+
+        mFramerFormantsDF->release(mConsumerFormantsDF);
+        mFramerFormantsLPC->release(mConsumerFormantsLPC);
+
+        const bool selectsOrder = dynamic_cast<Analysis::LP::OrderSelection *>(linpredSolver.get()) != nullptr;
+
+        double gain;
+        auto lpc = linpredSolver->solve(mLPC.data(), mLPC.size(), selectsOrder ? mFormantLpMaxOrder : 10, &gain);
+        auto formantResult = formantSolver->solve(lpc.data(), lpc.size(), fsFormantsLPC);
+
+        insertFormants(time, &formantResult);
     }
 }
 
 void Pipeline::callbackOscilloscope()
 {
-    const double fs = mCaptureBuffer->getSampleRate();
+    Framer::Frame frame;
 
-    rpm::vector<double> m(80.0 * fs / 1000.0);
+    while (mRunningThreads && !mStopThreads
+            && mFramerOscilloscope->pull(mConsumerOscilloscope, frame)) {
+        rpm::vector<double> out(frame.data, frame.data + frame.length);
+        mFramerOscilloscope->release(mConsumerOscilloscope);
 
-    double dfs = 8000;
-    Module::Audio::Resampler rs(fs, dfs);
-
-    double t = 0;
-
-    while (mRunningThreads && !mStopThreads) {
-        mBufferOscilloscope.pull(m.data(), m.size());
-
-        auto out = rs.process(m.data(), m.size());
-        auto invglotResult = mInvglotSolver->solve(out.data(), out.size(), dfs);
+        Analysis::InvglotResult invglotResult;
+        if (isVoiceActive(frame.time, frame.time + frame.length / frame.sampleRate)) {
+            auto invglotSolver = mInvglotSolver.get();
+            invglotResult = invglotSolver->solve(out.data(), out.size(), frame.sampleRate);
+        }
+        else {
+            invglotResult.sampleRate = frame.sampleRate;
+            invglotResult.glotSig.assign(out.size(), 0.0);
+        }
 
         mDataStore->beginWrite();
-       
-        mDataStore->getSoundTrack().insert(t, out);
-        mDataStore->getGifTrack().insert(t, invglotResult.glotSig);
 
-        mDataStore->endWrite();
+        mDataStore->getSoundTrack().insert(frame.time, out);
+        mDataStore->getGifTrack().insert(frame.time, invglotResult.glotSig);
 
-        t += m.size() / fs;
+        mDataStore->endWrite();
     }
 }
 
@@ -229,47 +448,37 @@ void Pipeline::processAll()
 {
     const double fs = (double) mCaptureBuffer->getSampleRate();
 
-    static int blockSize = 512;
-    rpm::vector<double> data(blockSize);
+    rpm::vector<double> data(mBlockSize);
     mCaptureBuffer->pull(data.data(), data.size());
-    mTime = mTime + blockSize / fs;
+    mTime = mTime + mBlockSize / fs;
 
     mDataStore->setTime(mTime);
 
-    mBufferSpectrogram.setSampleRate(fs);
-    mBufferPitch.setSampleRate(fs);
-    mBufferFormants.setSampleRate(fs);
-    mBufferOscilloscope.setSampleRate(fs);
-
-    rpm::vector<float> fdata(data.begin(), data.end());
-    mBufferSpectrogram.push(fdata.data(), data.size());
-    mBufferPitch.push(fdata.data(), data.size());
-    mBufferFormants.push(fdata.data(), data.size());
-    mBufferOscilloscope.push(fdata.data(), data.size());
-
     bool shouldNotBeRunning = false;
     if (mRunningThreads.compare_exchange_strong(shouldNotBeRunning, true)) {
+        createFramers(fs);
         mThreadSpectrogram = std::thread(std::mem_fn(&Pipeline::callbackSpectrogram), this);
         mThreadPitch = std::thread(std::mem_fn(&Pipeline::callbackPitch), this);
         mThreadFormants = std::thread(std::mem_fn(&Pipeline::callbackFormants), this);
         mThreadOscilloscope = std::thread(std::mem_fn(&Pipeline::callbackOscilloscope), this);
     }
 
+    pushFrames(data);
+
     // dynamically adjust blockSize to consume all the buffer.
-    static int lastBufferLength = 0;
     int bufferLength = mCaptureBuffer->getLength();
-    if (blockSize <= 16384 && lastBufferLength - bufferLength >= 8192) {
-        blockSize += 128;
+    if (mBlockSize <= 16384 && mLastBufferLength - bufferLength >= 8192) {
+        mBlockSize += 128;
         std::cout << "Processing too slowly, "
                   << bufferLength << " samples remaining. "
                   << "Adjusted block size to "
-                  << blockSize << " samples" << std::endl;
+                  << mBlockSize << " samples" << std::endl;
     }
-    else if (blockSize >= 512 && lastBufferLength - bufferLength <= -1024) {
-        blockSize -= 128;
+    else if (mBlockSize >= 512 && mLastBufferLength - bufferLength <= -1024) {
+        mBlockSize -= 128;
         std::cout << "Processing fast enough, "
                   << "adjusted block size to "
-                  << blockSize << " samples" << std::endl;
+                  << mBlockSize << " samples" << std::endl;
     }
-    lastBufferLength = bufferLength;
-} 
+    mLastBufferLength = bufferLength;
+}
@@ -6,8 +6,12 @@
 #include "../../audio/audio.h"
 #include "../../../context/datastore.h"
 #include "../../../context/config.h"
+#include "../../../context/solverslot.h"
+#include "framer.h"
 
 #include <atomic>
+#include <condition_variable>
+#include <mutex>
 #include <thread>
 #include <chrono>
 
@@ -20,10 +24,10 @@ namespace Module::App
     public:
         Pipeline(Module::Audio::Buffer *captureBuffer,
                 Main::DataStore *dataStore, Main::Config *config,
-                std::shared_ptr<Analysis::PitchSolver>& pitchSolver,
-                std::shared_ptr<Analysis::LinpredSolver>& linpredSolver,
-                std::shared_ptr<Analysis::FormantSolver>& formantSolver,
-                std::shared_ptr<Analysis::InvglotSolver>& invglotSolver);
+                Main::SolverSlot<Analysis::PitchSolver>& pitchSolver,
+                Main::SolverSlot<Analysis::LinpredSolver>& linpredSolver,
+                Main::SolverSlot<Analysis::FormantSolver>& formantSolver,
+                Main::SolverSlot<Analysis::InvglotSolver>& invglotSolver);
         ~Pipeline();
 
         void processAll();
@@ -33,32 +37,62 @@ namespace Module::App
         Main::DataStore *mDataStore;
         Main::Config *mConfig;
 
-        std::shared_ptr<Analysis::PitchSolver>& mPitchSolver;
-        std::shared_ptr<Analysis::LinpredSolver>& mLinpredSolver;
-        std::shared_ptr<Analysis::FormantSolver>& mFormantSolver;
-        std::shared_ptr<Analysis::InvglotSolver>& mInvglotSolver;
+        Main::SolverSlot<Analysis::PitchSolver>& mPitchSolver;
+        Main::SolverSlot<Analysis::LinpredSolver>& mLinpredSolver;
+        Main::SolverSlot<Analysis::FormantSolver>& mFormantSolver;
+        Main::SolverSlot<Analysis::InvglotSolver>& mInvglotSolver;
 
         std::atomic<double> mTime;
+        int mBlockSize;
+        int mLastBufferLength;
         std::atomic_bool mRunningThreads;
         std::atomic_bool mStopThreads;
+
+        void createFramers(double fs);
+        void pushFrames(const rpm::vector<double>& data);
+
+        std::unique_ptr<Framer> mFramer;
+
+        // Frames outside of voice activity skip the expensive solvers.
+        int mConsumerVoiceActivity;
+        Analysis::VoiceActivityDetector mVoiceActivityDetector;
+        bool mVoiceActivityEnabled;
+        double mVoiceActivityUntil;
+        rpm::deque<std::pair<double, double>> mVoiceActivity;
+        std::mutex mVoiceActivityMutex;
+        std::condition_variable mVoiceActivityCond;
+        void detectVoiceActivity();
+        bool isVoiceActive(double start, double end);
         
-        Module::Audio::Buffer mBufferSpectrogram;
+        std::unique_ptr<Framer> mFramerSpectrogram;
+        int mConsumerSpectrogram;
         std::thread mThreadSpectrogram;
         void callbackSpectrogram();
         Module::Audio::Resampler mSpectrumResampler;
+        rpm::vector<std::array<double, 6>> mSpectrumHighpass;
+        rpm::vector<rpm::vector<double>> mSpectrumHighpassMemory;
         std::unique_ptr<Analysis::RealFFT> mSpectrumFFT;
 
-        Module::Audio::Buffer mBufferPitch;
+        int mConsumerPitch;
         std::thread mThreadPitch;
         void callbackPitch();
 
-        Module::Audio::Buffer mBufferFormants;
+        std::unique_ptr<Framer> mFramerFormantsDF;
+        std::unique_ptr<Framer> mFramerFormantsLPC;
+        int mConsumerFormantsDF;
+        int mConsumerFormantsLPC;
+        int mFormantLpMaxOrder;
         std::thread mThreadFormants;
         void callbackFormants();
+        void insertFormants(double time, const Analysis::FormantResult *result);
+        Module::Audio::Resampler mFormantResamplerDF;
+        Module::Audio::Resampler mFormantResamplerLPC;
 
-        Module::Audio::Buffer mBufferOscilloscope;
+        std::unique_ptr<Framer> mFramerOscilloscope;
+        int mConsumerOscilloscope;
         std::thread mThreadOscilloscope;
         void callbackOscilloscope();
+        Module::Audio::Resampler mOscilloscopeResampler;
     };
 }
 
@@ -0,0 +1,69 @@
+#ifndef APP_SERVICE_PROTOCOL_H
+#define APP_SERVICE_PROTOCOL_H
+
+#include <cstdint>
+
+/*
+ *  Wire format of the analysis service.
+ *
+ *  Every message is a Header followed by `length` bytes of payload.
+ *  The service only listens on a local socket, so all fields use the
+ *  host byte order and IEEE-754 floats.
+ *
+ *  A client opens the stream with Hello, then sends Audio messages
+ *  and ends with Goodbye (or just closes the socket). The service
+ *  answers with Spectrogram, Pitch and Formants frames, timestamped
+ *  in seconds on the stream's own sample clock.
+ */
+
+namespace Module::App::Protocol
+{
+    constexpr uint32_t kMagic = 0x544D4649; // "IFMT"
+    constexpr uint16_t kVersion = 1;
+
+    constexpr uint32_t kMaxPayloadLength = 1 << 22;
+
+    enum class MessageType : uint16_t {
+        // Client to service.
+        Hello       = 1,    // StreamFormat
+        Audio       = 2,    // float32[frames * channels], interleaved
+        Goodbye     = 3,    // no payload
+
+        // Service to client.
+        Spectrogram = 16,   // SpectrogramFrame + float32[binCount]
+        Pitch       = 17,   // float32, NaN when unvoiced
+        Formants    = 18,   // uint32 count + FormantEntry[count]
+        Error       = 31,   // UTF-8 message, the service closes the stream afterwards
+    };
+
+#pragma pack(push, 1)
+    struct Header {
+        uint32_t magic;
+        uint16_t type;
+        uint16_t version;
+        uint32_t sequence;
+        uint32_t length;
+        double time;
+    };
+
+    struct StreamFormat {
+        uint32_t sampleRate;
+        uint32_t channels;
+    };
+
+    struct SpectrogramFrame {
+        float sampleRate;
+        float frameDuration;
+        uint32_t binCount;
+    };
+
+    struct FormantEntry {
+        float frequency;    // NaN when the track is not defined
+        float bandwidth;
+    };
+#pragma pack(pop)
+
+    static_assert(sizeof(Header) == 24, "Protocol::Header must be 24 bytes");
+}
+
+#endif // APP_SERVICE_PROTOCOL_H
@@ -0,0 +1,561 @@
+#include "service.h"
+#include "../../../context/solvermakers.h"
+
+#include <iostream>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+#if (defined(__unix__) || defined(__APPLE__)) && !defined(__EMSCRIPTEN__)
+#   define SERVICE_HAS_UNIX_SOCKETS
+#   include <cerrno>
+#   include <poll.h>
+#   include <sys/socket.h>
+#   include <sys/un.h>
+#   include <unistd.h>
+#endif
+
+#ifdef MSG_NOSIGNAL
+#   define SERVICE_SEND_FLAGS MSG_NOSIGNAL
+#else
+#   define SERVICE_SEND_FLAGS 0
+#endif
+
+using namespace Module::App;
+using namespace std::chrono_literals;
+
+// Spectrogram frames a lagging client is allowed to catch up on.
+// Anything older is dropped for that client only.
+static constexpr int kMaxSpectrogramBacklog = 16;
+
+// Seconds of analysis output a session holds on to, whether it was sent or not.
+static constexpr double kStreamWindow = 2.0;
+
+// Track entries reserved per session, a streaming window at a 5 ms hop.
+static constexpr int kSessionTrackReserve = 512;
+
+// Seconds of audio queued ahead of the analysis before the client is throttled.
+static constexpr double kMaxCaptureBacklog = 1.0;
+
+static void appendBytes(rpm::vector<char>& out, const void *data, size_t length)
+{
+    auto bytes = static_cast<const char *>(data);
+    out.insert(out.end(), bytes, bytes + length);
+}
+
+Service::Service(Main::Config *config, const std::string& socketPath)
+    : mConfig(config),
+      mSocketPath(socketPath),
+      mListenFd(-1),
+      mRunning(false)
+{
+#ifdef SERVICE_HAS_UNIX_SOCKETS
+    sockaddr_un addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+
+    if (mSocketPath.empty() || mSocketPath.size() >= sizeof(addr.sun_path)) {
+        throw std::runtime_error("Service] Invalid socket path \"" + mSocketPath + "\"");
+    }
+    std::strncpy(addr.sun_path, mSocketPath.c_str(), sizeof(addr.sun_path) - 1);
+
+    mListenFd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (mListenFd < 0) {
+        throw std::runtime_error(std::string("Service] Could not create socket: ") + std::strerror(errno));
+    }
+
+    // Remove a stale socket left behind by a previous instance.
+    ::unlink(mSocketPath.c_str());
+
+    if (::bind(mListenFd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0
+            || ::listen(mListenFd, 16) < 0) {
+        std::string err = std::strerror(errno);
+        ::close(mListenFd);
+        throw std::runtime_error("Service] Could not listen on \"" + mSocketPath + "\": " + err);
+    }
+#else
+    throw std::runtime_error("Service] UNIX domain sockets are not supported on this platform");
+#endif
+}
+
+Service::~Service()
+{
+    reapSessions(true);
+
+#ifdef SERVICE_HAS_UNIX_SOCKETS
+    if (mListenFd >= 0) {
+        ::close(mListenFd);
+        ::unlink(mSocketPath.c_str());
+    }
+#endif
+}
+
+int Service::exec()
+{
+#ifdef SERVICE_HAS_UNIX_SOCKETS
+    std::cout << "Service] Listening on " << mSocketPath << std::endl;
+
+    mRunning = true;
+
+    int nextId = 0;
+
+    while (mRunning) {
+        pollfd pfd;
+        pfd.fd = mListenFd;
+        pfd.events = POLLIN;
+        pfd.revents = 0;
+
+        int ret = ::poll(&pfd, 1, 200);
+
+        reapSessions(false);
+
+        if (ret <= 0 || !(pfd.revents & POLLIN)) {
+            continue;
+        }
+
+        int fd = ::accept(mListenFd, nullptr, nullptr);
+        if (fd < 0) {
+            continue;
+        }
+
+#if !defined(MSG_NOSIGNAL) && defined(SO_NOSIGPIPE)
+        int one = 1;
+        ::setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif
+
+        mSessions.push_back(std::make_unique<Session>(mConfig, fd, nextId++));
+    }
+
+    std::cout << "Service] Shutting down" << std::endl;
+
+    reapSessions(true);
+#endif
+
+    return 0;
+}
+
+void Service::stop()
+{
+    mRunning = false;
+}
+
+void Service::reapSessions(bool all)
+{
+    for (auto it = mSessions.begin(); it != mSessions.end(); ) {
+        if (all) {
+            (*it)->close();
+        }
+        if (all || (*it)->isFinished()) {
+            it = mSessions.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+}
+
+Service::Session::Session(Main::Config *config, int fd, int id)
+    : mConfig(config),
+      mFd(fd),
+      mId(id),
+      mRunning(true),
+      mFinished(false),
+      mChannels(1),
+      mSequence(0),
+      mSpectrogramCursor(-HUGE_VAL),
+      mPitchCursor(-HUGE_VAL),
+      mFormantCursor(-HUGE_VAL)
+{
+    mReaderThread = std::thread(std::mem_fn(&Session::readerLoop), this);
+}
+
+Service::Session::~Session()
+{
+    close();
+
+    if (mReaderThread.joinable())
+        mReaderThread.join();
+
+#ifdef SERVICE_HAS_UNIX_SOCKETS
+    ::close(mFd);
+#endif
+}
+
+void Service::Session::close()
+{
+    mRunning = false;
+#ifdef SERVICE_HAS_UNIX_SOCKETS
+    // Wakes up both the reader and the writer, the descriptor itself
+    // is only released once the session is destroyed.
+    ::shutdown(mFd, SHUT_RDWR);
+#endif
+}
+
+bool Service::Session::isFinished() const
+{
+    return mFinished;
+}
+
+void Service::Session::readerLoop()
+{
+    std::cout << "Service#" << mId << "] Client connected" << std::endl;
+
+    Protocol::Header header;
+    rpm::vector<char> payload;
+
+    if (readMessage(header, payload)) {
+        if (static_cast<Protocol::MessageType>(header.type) != Protocol::MessageType::Hello) {
+            sendError("Expected a Hello message");
+        }
+        else if (handleHello(payload)) {
+            mAnalysisThread = std::thread(std::mem_fn(&Session::analysisLoop), this);
+            mWriterThread = std::thread(std::mem_fn(&Session::writerLoop), this);
+
+            while (mRunning && readMessage(header, payload)) {
+                auto type = static_cast<Protocol::MessageType>(header.type);
+                if (type == Protocol::MessageType::Audio) {
+                    if (payload.size() % (sizeof(float) * mChannels) != 0) {
+                        sendError("Audio payload is not a whole number of frames");
+                        break;
+                    }
+                    handleAudio(payload);
+                }
+                else if (type == Protocol::MessageType::Goodbye) {
+                    waitForDrain();
+                    break;
+                }
+                else {
+                    sendError("Unexpected message type " + std::to_string(header.type));
+                    break;
+                }
+            }
+        }
+    }
+
+    mRunning = false;
+
+    if (mCaptureBuffer) {
+        mCaptureBuffer->cancelPull();
+    }
+
+    if (mAnalysisThread.joinable())
+        mAnalysisThread.join();
+
+    if (mWriterThread.joinable())
+        mWriterThread.join();
+
+    mPipeline.reset();
+
+    std::cout << "Service#" << mId << "] Client disconnected" << std::endl;
+
+    mFinished = true;
+}
+
+void Service::Session::analysisLoop()
+{
+    while (mRunning) {
+        mPipeline->processAll();
+        trimStore();
+    }
+}
+
+void Service::Session::writerLoop()
+{
+    rpm::vector<char> out;
+
+    while (mRunning) {
+        out.clear();
+        collectFrames(out);
+
+        if (!out.empty() && !sendAll(out.data(), out.size())) {
+            close();
+            return;
+        }
+
+        std::this_thread::sleep_for(10ms);
+    }
+
+    // Flush whatever the pipeline produced before the stream ended.
+    out.clear();
+    collectFrames(out);
+    if (!out.empty()) {
+        sendAll(out.data(), out.size());
+    }
+}
+
+bool Service::Session::readMessage(Protocol::Header& header, rpm::vector<char>& payload)
+{
+#ifdef SERVICE_HAS_UNIX_SOCKETS
+    auto recvAll = [this](void *data, size_t length) {
+        auto bytes = static_cast<char *>(data);
+        while (length > 0) {
+            ssize_t ret = ::recv(mFd, bytes, length, 0);
+            if (ret < 0 && errno == EINTR) {
+                continue;
+            }
+            if (ret <= 0) {
+                return false;
+            }
+            bytes += ret;
+            length -= ret;
+        }
+        return true;
+    };
+
+    if (!recvAll(&header, sizeof(header))) {
+        return false;
+    }
+
+    if (header.magic != Protocol::kMagic || header.version != Protocol::kVersion) {
+        sendError("Bad message header");
+        return false;
+    }
+
+    if (header.length > Protocol::kMaxPayloadLength) {
+        sendError("Message payload too large");
+        return false;
+    }
+
+    payload.resize(header.length);
+    return recvAll(payload.data(), payload.size());
+#else
+    return false;
+#endif
+}
+
+bool Service::Session::handleHello(const rpm::vector<char>& payload)
+{
+    Protocol::StreamFormat format;
+    if (payload.size() != sizeof(format)) {
+        sendError("Malformed Hello message");
+        return false;
+    }
+    std::memcpy(&format, payload.data(), sizeof(format));
+
+    if (format.sampleRate < 8000 || format.sampleRate > 192000) {
+        sendError("Unsupported sample rate " + std::to_string(format.sampleRate));
+        return false;
+    }
+
+    if (format.channels < 1 || format.channels > 8) {
+        sendError("Unsupported channel count " + std::to_string(format.channels));
+        return false;
+    }
+
+    mChannels = format.channels;
+
+    mPitchSolver = std::make_unique<Main::SolverSlot<Analysis::PitchSolver>>(
+            Main::makePitchSolver(mConfig->getPitchAlgorithm(), mConfig->getAnalysisPitchLookahead()));
+    mLinpredSolver = std::make_unique<Main::SolverSlot<Analysis::LinpredSolver>>(
+            Main::makeLinpredSolver(mConfig->getLinpredAlgorithm(), mConfig->getAnalysisLpOrderSelection()));
+    mFormantSolver = std::make_unique<Main::SolverSlot<Analysis::FormantSolver>>(
+            Main::makeFormantSolver(mConfig->getFormantAlgorithm(), mConfig->getAnalysisDeepFormantsThreads()));
+    mInvglotSolver = std::make_unique<Main::SolverSlot<Analysis::InvglotSolver>>(
+            Main::makeInvglotSolver(mConfig->getInvglotAlgorithm()));
+
+    mCaptureBuffer = std::make_unique<Module::Audio::Buffer>(format.sampleRate);
+    mDataStore = std::make_unique<Main::DataStore>(kSessionTrackReserve);
+    mDataStore->setFormantTrackCount(4);
+
+    mPipeline = std::make_unique<Pipeline>(
+                    mCaptureBuffer.get(), mDataStore.get(), mConfig,
+                    *mPitchSolver, *mLinpredSolver,
+                    *mFormantSolver, *mInvglotSolver);
+
+    std::cout << "Service#" << mId << "] Streaming at "
+              << format.sampleRate << " Hz, "
+              << format.channels << " channel(s)" << std::endl;
+
+    return true;
+}
+
+void Service::Session::handleAudio(const rpm::vector<char>& payload)
+{
+    const int frameCount = payload.size() / (sizeof(float) * mChannels);
+
+    mAudio.resize(frameCount * mChannels);
+    std::memcpy(mAudio.data(), payload.data(), payload.size());
+
+    // Downmix interleaved channels in place.
+    if (mChannels > 1) {
+        for (int i = 0; i < frameCount; ++i) {
+            float sum = 0.0f;
+            for (int ch = 0; ch < mChannels; ++ch) {
+                sum += mAudio[i * mChannels + ch];
+            }
+            mAudio[i] = sum / mChannels;
+        }
+    }
+
+    // Stop reading until the analysis catches up, the client's own sends then block.
+    const int maxBacklog = kMaxCaptureBacklog * mCaptureBuffer->getSampleRate();
+    while (mRunning && mCaptureBuffer->getLength() > maxBacklog) {
+        std::this_thread::sleep_for(5ms);
+    }
+
+    mCaptureBuffer->push(mAudio.data(), frameCount);
+}
+
+void Service::Session::waitForDrain()
+{
+    // Give the pipeline a chance to consume the tail of the stream.
+    for (int i = 0; i < 200 && mRunning; ++i) {
+        if (mCaptureBuffer->getLength() < 512) {
+            break;
+        }
+        std::this_thread::sleep_for(10ms);
+    }
+    std::this_thread::sleep_for(50ms);
+}
+
+void Service::Session::collectFrames(rpm::vector<char>& out)
+{
+    mDataStore->beginRead();
+
+    auto& spectrogram = mDataStore->getSpectrogram();
+    auto specFirst = spectrogram.upper_bound(mSpectrogramCursor);
+    if (std::distance(specFirst, spectrogram.end()) > kMaxSpectrogramBacklog) {
+        specFirst = std::prev(spectrogram.end(), kMaxSpectrogramBacklog);
+    }
+    for (auto it = specFirst; it != spectrogram.end(); ++it) {
+        const auto& coefs = it->second;
+
+        Protocol::SpectrogramFrame frame;
+        frame.sampleRate = coefs.sampleRate;
+        frame.frameDuration = coefs.frameDuration;
+        frame.binCount = coefs.magnitudes.size();
+
+        appendHeader(out, Protocol::MessageType::Spectrogram, it->first,
+                sizeof(frame) + frame.binCount * sizeof(float));
+        appendBytes(out, &frame, sizeof(frame));
+        for (int k = 0; k < (int) frame.binCount; ++k) {
+            float mag = coefs.magnitudes(k);
+            appendBytes(out, &mag, sizeof(mag));
+        }
+
+        mSpectrogramCursor = it->first;
+    }
+
+    auto& pitchTrack = mDataStore->getPitchTrack();
+    for (auto it = pitchTrack.upper_bound(mPitchCursor); it != pitchTrack.end(); ++it) {
+        float pitch = it->second.has_value() ? *it->second : NAN;
+
+        appendHeader(out, Protocol::MessageType::Pitch, it->first, sizeof(pitch));
+        appendBytes(out, &pitch, sizeof(pitch));
+
+        mPitchCursor = it->first;
+    }
+
+    // All formant and bandwidth tracks are written together, so they share indices.
+    const uint32_t formantCount = mDataStore->getFormantTrackCount();
+    if (formantCount > 0) {
+        auto& firstTrack = mDataStore->getFormantTrack(0);
+        auto first = firstTrack.upper_bound(mFormantCursor);
+        const int firstIndex = std::distance(firstTrack.begin(), first);
+        const int lastIndex = std::distance(firstTrack.begin(), firstTrack.end());
+
+        for (int index = firstIndex; index < lastIndex; ++index) {
+            const double time = std::next(firstTrack.begin(), index)->first;
+
+            appendHeader(out, Protocol::MessageType::Formants, time,
+                    sizeof(formantCount) + formantCount * sizeof(Protocol::FormantEntry));
+            appendBytes(out, &formantCount, sizeof(formantCount));
+
+            for (int i = 0; i < (int) formantCount; ++i) {
+                const auto& freq = std::next(mDataStore->getFormantTrack(i).begin(), index)->second;
+                const auto& bw = std::next(mDataStore->getFormantBandwidthTrack(i).begin(), index)->second;
+
+                Protocol::FormantEntry entry;
+                entry.frequency = freq.has_value() ? *freq : NAN;
+                entry.bandwidth = bw.has_value() ? *bw : NAN;
+                appendBytes(out, &entry, sizeof(entry));
+            }
+
+            mFormantCursor = time;
+        }
+    }
+
+    mDataStore->endRead();
+
+    // Nothing reads these tracks back once sent, so keep the session's memory bounded.
+    mDataStore->beginWrite();
+    spectrogram.erase(spectrogram.begin(), spectrogram.upper_bound(mSpectrogramCursor));
+    pitchTrack.erase(pitchTrack.begin(), pitchTrack.upper_bound(mPitchCursor));
+    for (int i = 0; i < (int) formantCount; ++i) {
+        auto& track = mDataStore->getFormantTrack(i);
+        track.erase(track.begin(), track.upper_bound(mFormantCursor));
+        auto& bwTrack = mDataStore->getFormantBandwidthTrack(i);
+        bwTrack.erase(bwTrack.begin(), bwTrack.upper_bound(mFormantCursor));
+    }
+    mDataStore->endWrite();
+}
+
+void Service::Session::trimStore()
+{
+    // The writer only trims what it sent, and it may be stuck on a stalled client.
+    // Anything older than the streaming window goes regardless.
+    auto trim = [](auto& track) {
+        if (!track.empty()) {
+            track.erase(track.begin(), track.upper_bound(std::prev(track.end())->first - kStreamWindow));
+        }
+    };
+
+    mDataStore->beginWrite();
+    trim(mDataStore->getSpectrogram());
+    trim(mDataStore->getPitchTrack());
+    for (int i = 0; i < mDataStore->getFormantTrackCount(); ++i) {
+        trim(mDataStore->getFormantTrack(i));
+        trim(mDataStore->getFormantBandwidthTrack(i));
+    }
+
+    // Never sent.
+    mDataStore->getSoundTrack().erase(mDataStore->getSoundTrack().begin(), mDataStore->getSoundTrack().end());
+    mDataStore->getGifTrack().erase(mDataStore->getGifTrack().begin(), mDataStore->getGifTrack().end());
+    mDataStore->getVoiceActivityTrack().erase(mDataStore->getVoiceActivityTrack().begin(), mDataStore->getVoiceActivityTrack().end());
+    mDataStore->endWrite();
+}
+
+void Service::Session::appendHeader(rpm::vector<char>& out, Protocol::MessageType type, double time, uint32_t length)
+{
+    Protocol::Header header;
+    header.magic = Protocol::kMagic;
+    header.type = static_cast<uint16_t>(type);
+    header.version = Protocol::kVersion;
+    header.sequence = mSequence++;
+    header.length = length;
+    header.time = time;
+
+    appendBytes(out, &header, sizeof(header));
+}
+
+bool Service::Session::sendAll(const char *data, size_t length)
+{
+#ifdef SERVICE_HAS_UNIX_SOCKETS
+    std::lock_guard<std::mutex> lock(mSendMutex);
+
+    while (length > 0) {
+        ssize_t ret = ::send(mFd, data, length, SERVICE_SEND_FLAGS);
+        if (ret < 0 && errno == EINTR) {
+            continue;
+        }
+        if (ret <= 0) {
+            return false;
+        }
+        data += ret;
+        length -= ret;
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+void Service::Session::sendError(const std::string& message)
+{
+    std::cout << "Service#" << mId << "] " << message << std::endl;
+
+    rpm::vector<char> out;
+    appendHeader(out, Protocol::MessageType::Error, 0.0, message.size());
+    appendBytes(out, message.data(), message.size());
+    sendAll(out.data(), out.size());
+}
@@ -0,0 +1,103 @@
+#ifndef APP_SERVICE_H
+#define APP_SERVICE_H
+
+#include "rpcxx.h"
+#include "../pipeline/pipeline.h"
+#include "protocol.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace Module::App
+{
+    /*
+     *  Headless analysis service on a UNIX domain socket.
+     *
+     *  Each connected client gets its own session: a private capture buffer,
+     *  data store, solver instances and Pipeline. Every per-session queue is
+     *  bounded: a slow or stalled client loses its own oldest results beyond
+     *  a short streaming window, and audio sent faster than it can be
+     *  analysed is left in the socket. Other sessions are never held back.
+     */
+    class Service {
+    public:
+        Service(Main::Config *config, const std::string& socketPath);
+        ~Service();
+
+        int exec();
+        void stop();
+
+    private:
+        class Session;
+
+        void reapSessions(bool all);
+
+        Main::Config *mConfig;
+        std::string mSocketPath;
+        int mListenFd;
+
+        std::atomic_bool mRunning;
+
+        rpm::vector<std::unique_ptr<Session>> mSessions;
+    };
+
+    class Service::Session {
+    public:
+        Session(Main::Config *config, int fd, int id);
+        ~Session();
+
+        void close();
+        bool isFinished() const;
+
+    private:
+        void readerLoop();
+        void analysisLoop();
+        void writerLoop();
+
+        bool readMessage(Protocol::Header& header, rpm::vector<char>& payload);
+        bool handleHello(const rpm::vector<char>& payload);
+        void handleAudio(const rpm::vector<char>& payload);
+        void waitForDrain();
+        void trimStore();
+
+        void collectFrames(rpm::vector<char>& out);
+        void appendHeader(rpm::vector<char>& out, Protocol::MessageType type, double time, uint32_t length);
+        bool sendAll(const char *data, size_t length);
+        void sendError(const std::string& message);
+
+        Main::Config *mConfig;
+        int mFd;
+        int mId;
+
+        std::atomic_bool mRunning;
+        std::atomic_bool mFinished;
+
+        int mChannels;
+        std::atomic<uint32_t> mSequence;
+        rpm::vector<float> mAudio;
+
+        double mSpectrogramCursor;
+        double mPitchCursor;
+        double mFormantCursor;
+
+        std::unique_ptr<Main::SolverSlot<Analysis::PitchSolver>> mPitchSolver;
+        std::unique_ptr<Main::SolverSlot<Analysis::LinpredSolver>> mLinpredSolver;
+        std::unique_ptr<Main::SolverSlot<Analysis::FormantSolver>> mFormantSolver;
+        std::unique_ptr<Main::SolverSlot<Analysis::InvglotSolver>> mInvglotSolver;
+
+        std::unique_ptr<Module::Audio::Buffer> mCaptureBuffer;
+        std::unique_ptr<Main::DataStore> mDataStore;
+        std::unique_ptr<Pipeline> mPipeline;
+
+        std::mutex mSendMutex;
+
+        std::thread mReaderThread;
+        std::thread mAnalysisThread;
+        std::thread mWriterThread;
+    };
+}
+
+#endif // APP_SERVICE_H
@@ -13,6 +13,7 @@ std::atomic_int Buffer::sId(0);
 Buffer::Buffer(double sampleRate)
     : mId(sId++),
       mSampleRate(sampleRate),
+      mCancel(false),
       mQueue(1024)
 {
 }
@@ -43,7 +44,7 @@ int Buffer::getLength() const
 void Buffer::pull(double *pOut, int outLength)
 {
     for (int i = 0; i < outLength; ++i) {
-        while (!mQueue.wait_dequeue_timed(pOut[i], 50) && !sCancel);
+        while (!mQueue.wait_dequeue_timed(pOut[i], 50) && !sCancel && !mCancel);
     }
 }
 
@@ -54,6 +55,11 @@ void Buffer::push(const float *pIn, int inLength)
     }
 }
 
+void Buffer::cancelPull()
+{
+    mCancel = true;
+}
+
 void Buffer::cancelPulls()
 {
     sCancel = true;
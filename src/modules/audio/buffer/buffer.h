@@ -24,12 +24,15 @@ namespace Module::Audio {
         void pull(double *pOut, int outLength);
         void push(const float *pIn, int inLength);
 
+        void cancelPull();
         static void cancelPulls();
 
     private:
         int mId;
         double mSampleRate;
 
+        std::atomic_bool mCancel;
+
         moodycamel::BlockingReaderWriterQueue<double> mQueue;
 
         static std::atomic_bool sCancel;
@@ -12,6 +12,7 @@
 using namespace Module::Audio;
 
 std::atomic_int Resampler::sId(0);
+std::mutex Resampler::sInLenBeforeOutStartMutex;
 rpm::map<std::pair<int, int>, int> Resampler::sInLenBeforeOutStart;
 
 Resampler::Resampler(int inRate)
@@ -128,6 +129,7 @@ void Resampler::setupResampler()
 int Resampler::getInLenBeforeOutStart(int src, int dst, r8b::CDSPResampler& resampler)
 {
     auto key = std::make_pair(src, dst);
+    std::lock_guard<std::mutex> lock(sInLenBeforeOutStartMutex);
     auto it = sInLenBeforeOutStart.find(key);
     int inLen;
     if (it != sInLenBeforeOutStart.end()) {
@@ -49,6 +49,8 @@ namespace Module::Audio {
         static std::atomic_int sId;
 
         static int getInLenBeforeOutStart(int src, int dst, r8b::CDSPResampler& resampler);
+        // Shared by every resampler in the process, mMutex only covers one instance.
+        static std::mutex sInLenBeforeOutStartMutex;
         static rpm::map<std::pair<int, int>, int> sInLenBeforeOutStart;
     };
 
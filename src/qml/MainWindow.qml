@@ -251,7 +251,7 @@ ApplicationWindow {
                     Label { text: "Pitch algorithm:" }
                     ComboBox {
                         implicitWidth: parent.width - 10
-                        model: [ "YIN", "McLeod", "RAPT" ]
+                        model: [ "YIN", "McLeod", "RAPT", "Streaming YIN", "1-bit AMDF", "IRAPT" ]
                         currentIndex: config.pitchAlgorithm
                         onActivated: config.pitchAlgorithm = currentIndex
                         Layout.alignment: Qt.AlignHCenter
@@ -262,7 +262,7 @@ ApplicationWindow {
                     Label { text: "Formant algorithm:" }
                     ComboBox {
                         implicitWidth: parent.width - 10
-                        model: [ "Simple LPC", "Filtered LPC", "DeepFormants" ]
+                        model: [ "Simple LPC", "Filtered LPC", "DeepFormants", "LPC envelope", "KARMA", "DeepFormants (int8)" ]
                         currentIndex: config.formantAlgorithm
                         onActivated: config.formantAlgorithm = currentIndex
                         Layout.alignment: Qt.AlignHCenter
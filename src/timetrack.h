@@ -12,7 +12,8 @@ public:
     using iterator       = typename vector_type::iterator;
     using const_iterator = typename vector_type::const_iterator;
     
-    TimeTrack();
+    // Storage for reserve entries is allocated up front.
+    explicit TimeTrack(int reserve = 1000000);
 
     void insert(double t, const T& o);
 
@@ -22,6 +23,14 @@ public:
     const_iterator lower_bound(double t) const;
     const_iterator upper_bound(double t) const;
 
+    iterator begin();
+    iterator end();
+
+    const_iterator begin() const;
+    const_iterator end() const;
+
+    iterator erase(iterator first, iterator last);
+
     const T& back() const;
 
     bool empty() const;
@@ -12,9 +12,9 @@ struct KeyComp {
 };
 
 template<typename T>
-TimeTrack<T>::TimeTrack()
+TimeTrack<T>::TimeTrack(int reserve)
 {
-    mTrack.reserve(1000000);
+    mTrack.reserve(reserve);
 }
 
 template<typename T>
@@ -47,6 +47,36 @@ typename TimeTrack<T>::const_iterator TimeTrack<T>::upper_bound(double t) const
     return std::upper_bound(mTrack.begin(), mTrack.end(), t, KeyComp<T>());
 }
 
+template<typename T>
+typename TimeTrack<T>::iterator TimeTrack<T>::begin()
+{
+    return mTrack.begin();
+}
+
+template<typename T>
+typename TimeTrack<T>::iterator TimeTrack<T>::end()
+{
+    return mTrack.end();
+}
+
+template<typename T>
+typename TimeTrack<T>::const_iterator TimeTrack<T>::begin() const
+{
+    return mTrack.begin();
+}
+
+template<typename T>
+typename TimeTrack<T>::const_iterator TimeTrack<T>::end() const
+{
+    return mTrack.end();
+}
+
+template<typename T>
+typename TimeTrack<T>::iterator TimeTrack<T>::erase(iterator first, iterator last)
+{
+    return mTrack.erase(first, last);
+}
+
 template<typename T>
 const T& TimeTrack<T>::back() const
 {